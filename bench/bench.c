@@ -0,0 +1,206 @@
+#include "bench.h"
+
+#include "SDL2/SDL.h"
+
+#include "chunk.h"
+#include "voxel.h"
+
+static const char* bench_fixture_names[BENCH_FIXTURE_COUNT] = {
+    "empty",
+    "full",
+    "flat",
+    "hills",
+    "caves",
+    "checkerboard",
+};
+
+// Small deterministic hash so the fixtures are identical on every platform
+static GLuint BenchHash(GLuint seed, int x, int y, int z) {
+    GLuint hash = seed ^ 0x9E3779B9u;
+    hash ^= (GLuint) x * 0x85EBCA6Bu; hash = (hash << 13) | (hash >> 19);
+    hash ^= (GLuint) y * 0xC2B2AE35u; hash = (hash << 13) | (hash >> 19);
+    hash ^= (GLuint) z * 0x27D4EB2Fu; hash = (hash << 13) | (hash >> 19);
+    hash ^= hash >> 16; hash *= 0x7FEB352Du;
+    hash ^= hash >> 15; hash *= 0x846CA68Bu;
+    hash ^= hash >> 16;
+
+    return hash;
+}
+
+static void FillColumn(chunk* chunk, int x, int z, int height) {
+    for(int y = 0; y < height && y < CHUNK_SIZE; y++) {
+        GLubyte type = y < height - 4 ? VOXEL_STONE : y < height - 1 ? VOXEL_DIRT : VOXEL_GRASS;
+        SetChunkVoxel(chunk, x, y, z, type);
+    }
+}
+
+// Value noise: hashed lattice values blended with a smoothstep
+static float BenchValueNoise(GLuint seed, float x, float z) {
+    int cell_x = (int) SDL_floorf(x);
+    int cell_z = (int) SDL_floorf(z);
+
+    float fraction_x = x - cell_x;
+    float fraction_z = z - cell_z;
+    fraction_x = fraction_x * fraction_x * (3.0f - 2.0f * fraction_x);
+    fraction_z = fraction_z * fraction_z * (3.0f - 2.0f * fraction_z);
+
+    float corners[4] = {
+        (BenchHash(seed, cell_x,     0, cell_z    ) & 0xFFFF) / 65535.0f,
+        (BenchHash(seed, cell_x + 1, 0, cell_z    ) & 0xFFFF) / 65535.0f,
+        (BenchHash(seed, cell_x,     0, cell_z + 1) & 0xFFFF) / 65535.0f,
+        (BenchHash(seed, cell_x + 1, 0, cell_z + 1) & 0xFFFF) / 65535.0f,
+    };
+
+    float top = corners[0] + (corners[1] - corners[0]) * fraction_x;
+    float bottom = corners[2] + (corners[3] - corners[2]) * fraction_x;
+
+    return top + (bottom - top) * fraction_z;
+}
+
+static SDL_malloc_func bench_malloc;
+static SDL_calloc_func bench_calloc;
+static SDL_realloc_func bench_realloc;
+static SDL_free_func bench_free;
+
+static bench_memory_stats bench_memory = { 0 };
+static SDL_SpinLock bench_memory_lock = 0; // The job workers allocate too, and SDL_atomic_t is too small for the bytes
+
+static void CountBenchAllocation(size_t size) {
+    SDL_AtomicLock(&bench_memory_lock);
+    bench_memory.allocations++;
+    bench_memory.bytes += size;
+    SDL_AtomicUnlock(&bench_memory_lock);
+}
+
+static void* SDLCALL BenchMalloc(size_t size) {
+    CountBenchAllocation(size);
+
+    return bench_malloc(size);
+}
+
+static void* SDLCALL BenchCalloc(size_t count, size_t size) {
+    CountBenchAllocation(count * size);
+
+    return bench_calloc(count, size);
+}
+
+static void* SDLCALL BenchRealloc(void* memory, size_t size) {
+    CountBenchAllocation(size);
+
+    return bench_realloc(memory, size);
+}
+
+static void SDLCALL BenchFree(void* memory) {
+    if(memory) {
+        SDL_AtomicLock(&bench_memory_lock);
+        bench_memory.frees++;
+        SDL_AtomicUnlock(&bench_memory_lock);
+    }
+
+    bench_free(memory);
+}
+
+void LoadBenchMemory() {
+    SDL_GetMemoryFunctions(&bench_malloc, &bench_calloc, &bench_realloc, &bench_free);
+    SDL_SetMemoryFunctions(BenchMalloc, BenchCalloc, BenchRealloc, BenchFree);
+}
+
+bench_memory_stats GetBenchMemoryStats() {
+    SDL_AtomicLock(&bench_memory_lock);
+    bench_memory_stats stats = bench_memory;
+    SDL_AtomicUnlock(&bench_memory_lock);
+
+    return stats;
+}
+
+void ResetBenchMemoryStats() {
+    SDL_AtomicLock(&bench_memory_lock);
+    bench_memory = (bench_memory_stats) { 0 };
+    SDL_AtomicUnlock(&bench_memory_lock);
+}
+
+double GetBenchTime() {
+    return (double) SDL_GetPerformanceCounter() / (double) SDL_GetPerformanceFrequency();
+}
+
+const char* GetBenchFixtureName(bench_fixture fixture) {
+    return bench_fixture_names[fixture];
+}
+
+void FillBenchFixture(chunk* chunk, bench_fixture fixture, GLuint seed) {
+    FillChunk(chunk, VOXEL_AIR);
+
+    switch(fixture) {
+        case BENCH_FIXTURE_EMPTY: break;
+
+        case BENCH_FIXTURE_FULL: {
+            FillChunk(chunk, VOXEL_STONE);
+        } break;
+
+        case BENCH_FIXTURE_FLAT: {
+            for(int z = 0; z < CHUNK_SIZE; z++) {
+                for(int x = 0; x < CHUNK_SIZE; x++) {
+                    FillColumn(chunk, x, z, CHUNK_SIZE / 2);
+                }
+            }
+        } break;
+
+        case BENCH_FIXTURE_HILLS: {
+            for(int z = 0; z < CHUNK_SIZE; z++) {
+                for(int x = 0; x < CHUNK_SIZE; x++) {
+                    // Terraced hills: a couple of overlapping triangle waves
+                    int wave_x = x % 16 < 8 ? x % 8 : 8 - x % 8;
+                    int wave_z = z % 12 < 6 ? z % 6 : 6 - z % 6;
+                    FillColumn(chunk, x, z, 10 + wave_x + wave_z);
+                }
+            }
+        } break;
+
+        case BENCH_FIXTURE_CAVES: {
+            for(int y = 0; y < CHUNK_SIZE; y++) {
+                for(int z = 0; z < CHUNK_SIZE; z++) {
+                    for(int x = 0; x < CHUNK_SIZE; x++) {
+                        // Roughly 70% solid with scattered holes, 2x2x2 clumps so some faces can merge
+                        GLuint hash = BenchHash(seed, x / 2, y / 2, z / 2);
+                        SetChunkVoxel(chunk, x, y, z, (hash % 10) < 7 ? VOXEL_STONE : VOXEL_AIR);
+                    }
+                }
+            }
+        } break;
+
+        case BENCH_FIXTURE_CHECKERBOARD: {
+            for(int y = 0; y < CHUNK_SIZE; y++) {
+                for(int z = 0; z < CHUNK_SIZE; z++) {
+                    for(int x = 0; x < CHUNK_SIZE; x++) {
+                        SetChunkVoxel(chunk, x, y, z, ((x + y + z) & 1) ? VOXEL_STONE : VOXEL_AIR);
+                    }
+                }
+            }
+        } break;
+
+        default: break;
+    }
+
+    chunk->dirty = true;
+}
+
+void FillBenchTerrain(chunk* chunk, GLuint seed) {
+    FillChunk(chunk, VOXEL_AIR);
+
+    for(int z = 0; z < CHUNK_SIZE; z++) {
+        for(int x = 0; x < CHUNK_SIZE; x++) {
+            float world_x = chunk->position[0] * CHUNK_SIZE + x;
+            float world_z = chunk->position[2] * CHUNK_SIZE + z;
+
+            // Two octaves: rolling hills plus some small bumps, 8 to 56 voxels high
+            float height = 8.0f + 40.0f * BenchValueNoise(seed, world_x / 48.0f, world_z / 48.0f) + 8.0f * BenchValueNoise(seed + 1, world_x / 12.0f, world_z / 12.0f);
+
+            int column_height = (int) height - chunk->position[1] * CHUNK_SIZE;
+            if(column_height > 0) {
+                FillColumn(chunk, x, z, column_height);
+            }
+        }
+    }
+
+    chunk->dirty = true;
+}
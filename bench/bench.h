@@ -0,0 +1,52 @@
+#if !defined (BENCH_H)
+#define BENCH_H
+
+#include "glad/glad.h"
+
+#include "chunk.h"
+
+typedef struct {
+    GLuint calls;
+    GLuint draw_calls;
+    GLuint64 bytes_uploaded;
+} bench_gl_stats;
+
+typedef struct {
+    GLuint allocations; // malloc, calloc and realloc calls
+    GLuint frees;
+    GLuint64 bytes; // Requested by the allocations above
+} bench_memory_stats;
+
+typedef enum {
+    BENCH_FIXTURE_EMPTY,
+    BENCH_FIXTURE_FULL,
+    BENCH_FIXTURE_FLAT,
+    BENCH_FIXTURE_HILLS,
+    BENCH_FIXTURE_CAVES,
+    BENCH_FIXTURE_CHECKERBOARD,
+    BENCH_FIXTURE_COUNT
+} bench_fixture;
+
+// Seconds elapsed since an arbitrary point, from the SDL performance counter
+double GetBenchTime();
+
+// Points the glad entry points used by the engine at no-op stubs (see bench_gl.c)
+void LoadBenchGL();
+bench_gl_stats GetBenchGLStats();
+void ResetBenchGLStats();
+
+// Routes SDL's allocator (used by all of the engine) through counting wrappers.
+// Must be called before anything is allocated.
+void LoadBenchMemory();
+bench_memory_stats GetBenchMemoryStats();
+void ResetBenchMemoryStats();
+
+const char* GetBenchFixtureName(bench_fixture fixture);
+
+// Fills the chunk with a reproducible canned layout; 'seed' only affects the noisy fixtures
+void FillBenchFixture(chunk* chunk, bench_fixture fixture, GLuint seed);
+
+// Reproducible terrain that is continuous across chunk borders (hash-based value noise heightmap)
+void FillBenchTerrain(chunk* chunk, GLuint seed);
+
+#endif // BENCH_H
@@ -0,0 +1,113 @@
+#include "bench.h"
+
+#include <stdlib.h>
+
+#include "glad/glad.h"
+
+// No-op replacements for the OpenGL entry points used by the engine, so the
+// CPU side of the renderer can be measured without a window or a context.
+// Every call is counted, as are the bytes that would have been uploaded.
+
+static GLuint bench_gl_names = 0;
+static bench_gl_stats bench_gl = { 0 };
+
+// Mapped ranges point here, outside of the counted allocations
+static void* bench_gl_mapping = NULL;
+static GLsizeiptr bench_gl_mapping_size = 0;
+
+static void APIENTRY StubGenObjects(GLsizei n, GLuint* names) {
+    bench_gl.calls++;
+
+    for(GLsizei index = 0; index < n; index++) {
+        names[index] = ++bench_gl_names;
+    }
+}
+
+static void APIENTRY StubDeleteObjects(GLsizei n, const GLuint* names) { bench_gl.calls++; }
+static void APIENTRY StubBindVertexArray(GLuint array) { bench_gl.calls++; }
+static void APIENTRY StubBindBuffer(GLenum target, GLuint buffer) { bench_gl.calls++; }
+static void APIENTRY StubBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) { bench_gl.calls++; bench_gl.bytes_uploaded += data ? size : 0; }
+static void APIENTRY StubBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) { bench_gl.calls++; bench_gl.bytes_uploaded += size; }
+static void APIENTRY StubVertexAttribArray(GLuint index) { bench_gl.calls++; }
+static void APIENTRY StubVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer) { bench_gl.calls++; }
+static void APIENTRY StubVertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsizei stride, const void* pointer) { bench_gl.calls++; }
+static void APIENTRY StubUseProgram(GLuint program) { bench_gl.calls++; }
+static GLint APIENTRY StubGetUniformLocation(GLuint program, const GLchar* name) { bench_gl.calls++; return 0; }
+static void APIENTRY StubUniform3fv(GLint location, GLsizei count, const GLfloat* value) { bench_gl.calls++; }
+static void APIENTRY StubUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) { bench_gl.calls++; }
+static void APIENTRY StubDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices) { bench_gl.calls++; bench_gl.draw_calls++; }
+static void APIENTRY StubCopyBufferSubData(GLenum read_target, GLenum write_target, GLintptr read_offset, GLintptr write_offset, GLsizeiptr size) { bench_gl.calls++; }
+static void APIENTRY StubActiveTexture(GLenum texture) { bench_gl.calls++; }
+static void APIENTRY StubBindTexture(GLenum target, GLuint texture) { bench_gl.calls++; }
+static void APIENTRY StubTexBuffer(GLenum target, GLenum format, GLuint buffer) { bench_gl.calls++; }
+static void APIENTRY StubMultiDrawElementsBaseVertex(GLenum mode, const GLsizei* count, GLenum type, const void* const* indices, GLsizei draw_count, const GLint* base_vertex) { bench_gl.calls++; bench_gl.draw_calls++; }
+static void APIENTRY StubDrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLint base_vertex) { bench_gl.calls++; bench_gl.draw_calls++; }
+static GLboolean APIENTRY StubUnmapBuffer(GLenum target) { bench_gl.calls++; return GL_TRUE; }
+static GLsync APIENTRY StubFenceSync(GLenum condition, GLbitfield flags) { bench_gl.calls++; return (GLsync) &bench_gl; }
+static GLenum APIENTRY StubClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout) { bench_gl.calls++; return GL_ALREADY_SIGNALED; }
+static void APIENTRY StubDeleteSync(GLsync sync) { bench_gl.calls++; }
+
+static void* APIENTRY StubMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access) {
+    bench_gl.calls++;
+    bench_gl.bytes_uploaded += length;
+
+    if(length > bench_gl_mapping_size) {
+        void* mapping = realloc(bench_gl_mapping, length);
+        if(!mapping) {
+            return NULL;
+        }
+
+        bench_gl_mapping = mapping;
+        bench_gl_mapping_size = length;
+    }
+
+    return bench_gl_mapping;
+}
+
+void LoadBenchGL() {
+    glad_glGenVertexArrays = StubGenObjects;
+    glad_glGenBuffers = StubGenObjects;
+    glad_glDeleteVertexArrays = StubDeleteObjects;
+    glad_glDeleteBuffers = StubDeleteObjects;
+    glad_glGenTextures = StubGenObjects;
+    glad_glDeleteTextures = StubDeleteObjects;
+
+    glad_glBindVertexArray = StubBindVertexArray;
+    glad_glBindBuffer = StubBindBuffer;
+    glad_glBufferData = StubBufferData;
+    glad_glBufferSubData = StubBufferSubData;
+    glad_glCopyBufferSubData = StubCopyBufferSubData;
+
+    glad_glActiveTexture = StubActiveTexture;
+    glad_glBindTexture = StubBindTexture;
+    glad_glTexBuffer = StubTexBuffer;
+
+    glad_glEnableVertexAttribArray = StubVertexAttribArray;
+    glad_glDisableVertexAttribArray = StubVertexAttribArray;
+    glad_glVertexAttribPointer = StubVertexAttribPointer;
+    glad_glVertexAttribIPointer = StubVertexAttribIPointer;
+
+    glad_glUseProgram = StubUseProgram;
+    glad_glGetUniformLocation = StubGetUniformLocation;
+    glad_glUniform3fv = StubUniform3fv;
+    glad_glUniformMatrix4fv = StubUniformMatrix4fv;
+
+    glad_glMapBufferRange = StubMapBufferRange;
+    glad_glUnmapBuffer = StubUnmapBuffer;
+
+    glad_glFenceSync = StubFenceSync;
+    glad_glClientWaitSync = StubClientWaitSync;
+    glad_glDeleteSync = StubDeleteSync;
+
+    glad_glDrawElements = StubDrawElements;
+    glad_glDrawElementsBaseVertex = StubDrawElementsBaseVertex;
+    glad_glMultiDrawElementsBaseVertex = StubMultiDrawElementsBaseVertex;
+}
+
+bench_gl_stats GetBenchGLStats() {
+    return bench_gl;
+}
+
+void ResetBenchGLStats() {
+    bench_gl = (bench_gl_stats) { 0 };
+}
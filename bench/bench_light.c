@@ -0,0 +1,240 @@
+#include <stdio.h>
+
+#include "SDL2/SDL.h"
+
+#include "bench.h"
+#include "chunk.h"
+#include "light.h"
+
+// Measures the voxel lighting on a block of terrain chunks: lighting it from scratch, then single edits lit
+// incrementally (placing and breaking lamps, placing and breaking blocks in the sunlight) against relighting
+// every chunk again. Counts the light jobs each edit took and the chunks left to remesh, and checks the light
+// the edits leave behind against a full relight.
+// Everything runs on the main thread, the engine runs the same light jobs on its workers.
+
+#define BENCH_SEED 1337
+#define BENCH_WIDTH 6 // In chunks, along X and Z
+#define BENCH_HEIGHT 2 // In chunks, along Y
+#define BENCH_CHUNKS (BENCH_WIDTH * BENCH_WIDTH * BENCH_HEIGHT)
+#define BENCH_EDITS 32
+
+static const int bench_face_offsets[VOXEL_FACE_COUNT][3] = {
+    {  0,  1,  0 }, // Face: UP
+    {  0, -1,  0 }, // Face: DOWN
+    {  0,  0,  1 }, // Face: FRONT
+    {  0,  0, -1 }, // Face: BACK
+    { -1,  0,  0 }, // Face: LEFT
+    {  1,  0,  0 }, // Face: RIGHT
+};
+
+static chunk* bench_chunks[BENCH_CHUNKS];
+static GLubyte bench_light[BENCH_CHUNKS][CHUNK_VOLUME]; // Left by the incremental edits, checked against a full relight
+
+typedef struct {
+    GLuint jobs; // Light jobs run, a chunk can be relit more than once while the light spreads back and forth
+    GLuint remeshed; // Chunks left dirty, by the edit or by their light changing
+    double seconds;
+} light_result;
+
+// Reproducible spread of the edits, the same for every kind of edit
+static GLuint GetBenchRandom(GLuint value) {
+    value ^= value >> 16; value *= 0x7FEB352Du;
+    value ^= value >> 15; value *= 0x846CA68Bu;
+    value ^= value >> 16;
+
+    return value;
+}
+
+static GLuint GetBenchChunkIndex(int x, int y, int z) {
+    return x + z * BENCH_WIDTH + y * BENCH_WIDTH * BENCH_WIDTH;
+}
+
+// Lights the pending chunks until the light has stopped spreading
+static light_result SettleBenchLight() {
+    light_result result = { 0 };
+
+    for(GLuint index = 0; index < BENCH_CHUNKS; index++) {
+        bench_chunks[index]->dirty = false;
+    }
+
+    double start = GetBenchTime();
+
+    for(bool pending = true; pending; ) {
+        pending = false;
+
+        for(GLuint index = 0; index < BENCH_CHUNKS; index++) {
+            chunk* chunk = bench_chunks[index];
+
+            if(IsChunkLightPending(chunk)) {
+                LightChunk(chunk, chunk->position[1] == BENCH_HEIGHT - 1);
+
+                result.jobs++;
+                pending = true;
+            }
+        }
+    }
+
+    result.seconds = GetBenchTime() - start;
+
+    for(GLuint index = 0; index < BENCH_CHUNKS; index++) {
+        result.remeshed += bench_chunks[index]->dirty;
+    }
+
+    return result;
+}
+
+static light_result RelightBenchChunks() {
+    for(GLuint index = 0; index < BENCH_CHUNKS; index++) {
+        QueueChunkLightReset(bench_chunks[index]);
+    }
+
+    return SettleBenchLight();
+}
+
+// Relights every chunk from scratch, which has to land on the light the edits left behind
+static bool CheckBenchLight() {
+    for(GLuint index = 0; index < BENCH_CHUNKS; index++) {
+        DecodeChunkStorage(&bench_chunks[index]->light, 0, CHUNK_VOLUME, bench_light[index]);
+    }
+
+    RelightBenchChunks();
+
+    bool identical = true;
+
+    for(GLuint index = 0; index < BENCH_CHUNKS; index++) {
+        GLubyte light[CHUNK_VOLUME];
+        DecodeChunkStorage(&bench_chunks[index]->light, 0, CHUNK_VOLUME, light);
+
+        identical &= SDL_memcmp(light, bench_light[index], CHUNK_VOLUME) == 0;
+    }
+
+    return identical;
+}
+
+// Highest solid voxel of the column, in voxels from the bottom of the bench
+static int GetBenchSurface(int x, int z) {
+    for(int y = BENCH_HEIGHT * CHUNK_SIZE - 1; y > 0; y--) {
+        chunk* chunk = bench_chunks[GetBenchChunkIndex(x / CHUNK_SIZE, y / CHUNK_SIZE, z / CHUNK_SIZE)];
+
+        if(GetChunkVoxel(chunk, x % CHUNK_SIZE, y % CHUNK_SIZE, z % CHUNK_SIZE) != VOXEL_AIR) {
+            return y;
+        }
+    }
+
+    return 0;
+}
+
+static void SetBenchVoxel(int x, int y, int z, GLubyte type) {
+    chunk* chunk = bench_chunks[GetBenchChunkIndex(x / CHUNK_SIZE, y / CHUNK_SIZE, z / CHUNK_SIZE)];
+
+    SetChunkVoxel(chunk, x % CHUNK_SIZE, y % CHUNK_SIZE, z % CHUNK_SIZE, type);
+}
+
+// Places 'type' on the surface of BENCH_EDITS spread out columns, one at a time, then breaks them again.
+// Returns whether the light matched a full relight after both
+static bool RunBenchEdits(const char* name, GLubyte type, int height) {
+    light_result place = { 0 };
+    light_result remove = { 0 };
+
+    int positions[BENCH_EDITS][3];
+
+    for(int edit = 0; edit < BENCH_EDITS; edit++) {
+        // Away from the outer border, where the light of the missing chunks would be cut off
+        int x = CHUNK_SIZE + GetBenchRandom(BENCH_SEED + edit * 2) % (CHUNK_SIZE * (BENCH_WIDTH - 2));
+        int z = CHUNK_SIZE + GetBenchRandom(BENCH_SEED + edit * 2 + 1) % (CHUNK_SIZE * (BENCH_WIDTH - 2));
+        int y = SDL_min(GetBenchSurface(x, z) + height, BENCH_HEIGHT * CHUNK_SIZE - 1);
+
+        positions[edit][0] = x;
+        positions[edit][1] = y;
+        positions[edit][2] = z;
+
+        SetBenchVoxel(x, y, z, type);
+
+        light_result result = SettleBenchLight();
+        place.jobs += result.jobs;
+        place.remeshed += result.remeshed;
+        place.seconds += result.seconds;
+    }
+
+    bool identical = CheckBenchLight();
+
+    for(int edit = BENCH_EDITS - 1; edit >= 0; edit--) {
+        SetBenchVoxel(positions[edit][0], positions[edit][1], positions[edit][2], VOXEL_AIR);
+
+        light_result result = SettleBenchLight();
+        remove.jobs += result.jobs;
+        remove.remeshed += result.remeshed;
+        remove.seconds += result.seconds;
+    }
+
+    identical &= CheckBenchLight();
+
+    printf("%-14s | %10.1f %10.2f %10.2f |\n", name, place.seconds / BENCH_EDITS * 1e6, (double) place.jobs / BENCH_EDITS, (double) place.remeshed / BENCH_EDITS);
+
+    char remove_name[32];
+    SDL_snprintf(remove_name, sizeof(remove_name), "%s break", name);
+    printf("%-14s | %10.1f %10.2f %10.2f |\n", remove_name, remove.seconds / BENCH_EDITS * 1e6, (double) remove.jobs / BENCH_EDITS, (double) remove.remeshed / BENCH_EDITS);
+
+    return identical;
+}
+
+int main(int argc, char* argv[]) {
+    for(int y = 0; y < BENCH_HEIGHT; y++) {
+        for(int z = 0; z < BENCH_WIDTH; z++) {
+            for(int x = 0; x < BENCH_WIDTH; x++) {
+                chunk* chunk = LoadChunk((ivec3) { x, y, z });
+                if(!chunk) {
+                    return 1;
+                }
+
+                FillBenchTerrain(chunk, BENCH_SEED);
+                bench_chunks[GetBenchChunkIndex(x, y, z)] = chunk;
+            }
+        }
+    }
+
+    for(int y = 0; y < BENCH_HEIGHT; y++) {
+        for(int z = 0; z < BENCH_WIDTH; z++) {
+            for(int x = 0; x < BENCH_WIDTH; x++) {
+                for(int face = 0; face < VOXEL_FACE_COUNT; face++) {
+                    int neighbour[3] = { x + bench_face_offsets[face][0], y + bench_face_offsets[face][1], z + bench_face_offsets[face][2] };
+
+                    if(neighbour[0] >= 0 && neighbour[0] < BENCH_WIDTH && neighbour[1] >= 0 && neighbour[1] < BENCH_HEIGHT && neighbour[2] >= 0 && neighbour[2] < BENCH_WIDTH) {
+                        bench_chunks[GetBenchChunkIndex(x, y, z)]->neighbours[face] = bench_chunks[GetBenchChunkIndex(neighbour[0], neighbour[1], neighbour[2])];
+                    }
+                }
+            }
+        }
+    }
+
+    printf("seed %u, %dx%dx%d chunks\n\n", BENCH_SEED, BENCH_WIDTH, BENCH_HEIGHT, BENCH_WIDTH);
+
+    light_result initial = SettleBenchLight();
+    light_result full = RelightBenchChunks();
+
+    printf("%-14s | %10s %10s %10s | %10s\n", "pass", "ms", "jobs", "remeshed", "chunks/s");
+    printf("---------------+----------------------------------+-----------\n");
+    printf("%-14s | %10.2f %10u %10u | %10.1f\n", "initial", initial.seconds * 1e3, initial.jobs, initial.remeshed, BENCH_CHUNKS / initial.seconds);
+    printf("%-14s | %10.2f %10u %10u | %10.1f\n", "full relight", full.seconds * 1e3, full.jobs, full.remeshed, BENCH_CHUNKS / full.seconds);
+
+    printf("\n%-14s | %10s %10s %10s |\n", "edit", "us", "jobs", "remeshed");
+    printf("---------------+----------------------------------+\n");
+
+    bool identical = true;
+    identical &= RunBenchEdits("lamp", VOXEL_LAMP, 1);
+    identical &= RunBenchEdits("block", VOXEL_STONE, 1);
+    identical &= RunBenchEdits("roof", VOXEL_STONE, 6); // Floating, so its shadow reaches further down and sideways
+
+    printf("\nper edit, against %.1f us to relight all %d chunks\n", full.seconds * 1e6, BENCH_CHUNKS);
+    printf("incremental light matches a full relight: %s\n", identical ? "yes" : "NO");
+
+    for(GLuint index = 0; index < BENCH_CHUNKS; index++) {
+        for(int face = 0; face < VOXEL_FACE_COUNT; face++) {
+            bench_chunks[index]->neighbours[face] = NULL;
+        }
+
+        UnloadChunk(bench_chunks[index]);
+    }
+
+    return 0;
+}
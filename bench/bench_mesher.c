@@ -0,0 +1,109 @@
+#include <stdio.h>
+
+#include "SDL2/SDL.h"
+
+#include "bench.h"
+#include "chunk.h"
+
+// Compares naive face culling against greedy meshing on the canned chunk fixtures, then the greedy meshes
+// of every level of detail. Everything runs on the CPU, no window or OpenGL context is needed.
+
+#define BENCH_ITERATIONS 64
+
+typedef struct {
+    GLuint quads;
+    GLuint vertices;
+    GLuint indices;
+    double seconds; // Average time of a single mesh build
+} mesher_result;
+
+static mesher_result RunMesher(chunk* chunk, chunk_mesh_mode mode) {
+    mesher_result result = { 0 };
+
+    chunk->mesh_mode = mode;
+    BuildChunkMesh(chunk); // Warm-up, also grows the mesh buffers to their final size
+
+    double start = GetBenchTime();
+    for(int iteration = 0; iteration < BENCH_ITERATIONS; iteration++) {
+        BuildChunkMesh(chunk);
+    }
+    result.seconds = (GetBenchTime() - start) / BENCH_ITERATIONS;
+
+    result.vertices = chunk->mesh.vertices_count;
+    result.indices = chunk->mesh.indices_count;
+    result.quads = chunk->mesh.indices_count / 6;
+
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    chunk* chunk = LoadChunk((ivec3) { 0, 0, 0 });
+    if(!chunk) {
+        return 1;
+    }
+
+    printf("%-14s | %10s %10s %8s | %10s %10s %8s\n", "fixture", "naive quad", "greedy", "ratio", "naive us", "greedy us", "speedup");
+    printf("---------------+-------------------------------+-------------------------------\n");
+
+    GLuint naive_total = 0;
+    GLuint greedy_total = 0;
+
+    for(int fixture = 0; fixture < BENCH_FIXTURE_COUNT; fixture++) {
+        FillBenchFixture(chunk, fixture, 1337);
+
+        mesher_result naive = RunMesher(chunk, CHUNK_MESH_NAIVE);
+        mesher_result greedy = RunMesher(chunk, CHUNK_MESH_GREEDY);
+
+        naive_total += naive.quads;
+        greedy_total += greedy.quads;
+
+        printf(
+            "%-14s | %10u %10u %7.2fx | %10.1f %10.1f %7.2fx\n",
+            GetBenchFixtureName(fixture),
+            naive.quads, greedy.quads, greedy.quads ? (double) naive.quads / greedy.quads : 0.0,
+            naive.seconds * 1e6, greedy.seconds * 1e6, greedy.seconds > 0.0 ? naive.seconds / greedy.seconds : 0.0
+        );
+    }
+
+    printf("---------------+-------------------------------+-------------------------------\n");
+    printf("%-14s | %10u %10u %7.2fx |\n", "total", naive_total, greedy_total, greedy_total ? (double) naive_total / greedy_total : 0.0);
+
+    // Coarse levels build every border face (see GetChunkSeams), which the full resolution mesh of a lone chunk doesn't
+    printf("\n%-14s |", "greedy quads");
+    for(int lod = 0; lod < CHUNK_LOD_COUNT; lod++) {
+        printf(" %7s%-2d", "lod ", lod);
+    }
+    printf(" |");
+    for(int lod = 0; lod < CHUNK_LOD_COUNT; lod++) {
+        printf(" %6s%-2d us", "lod ", lod);
+    }
+    printf("\n---------------+-----------------------------------------+--------------------------------------------\n");
+
+    chunk->mesh_mode = CHUNK_MESH_GREEDY;
+
+    for(int fixture = 0; fixture < BENCH_FIXTURE_COUNT; fixture++) {
+        FillBenchFixture(chunk, fixture, 1337);
+
+        mesher_result results[CHUNK_LOD_COUNT];
+        for(int lod = 0; lod < CHUNK_LOD_COUNT; lod++) {
+            SetChunkLod(chunk, lod);
+            results[lod] = RunMesher(chunk, CHUNK_MESH_GREEDY);
+        }
+
+        printf("%-14s |", GetBenchFixtureName(fixture));
+        for(int lod = 0; lod < CHUNK_LOD_COUNT; lod++) {
+            printf(" %9u", results[lod].quads);
+        }
+        printf(" |");
+        for(int lod = 0; lod < CHUNK_LOD_COUNT; lod++) {
+            printf(" %10.1f", results[lod].seconds * 1e6);
+        }
+        printf("\n");
+    }
+
+    SetChunkLod(chunk, 0);
+
+    UnloadChunk(chunk);
+
+    return 0;
+}
@@ -0,0 +1,307 @@
+#include <stdio.h>
+
+#include "SDL2/SDL.h"
+
+#include "bench.h"
+#include "chunk.h"
+#include "chunk_arena.h"
+#include "core.h"
+#include "job.h"
+#include "render_batch.h"
+#include "voxel.h"
+
+// Runs every CPU stage between voxel data and draw calls on reproducible worlds of growing size:
+// terrain generation, face culling, greedy meshing, threaded meshing, mesh upload, batch filling and chunk drawing.
+// OpenGL is stubbed out (see bench_gl.c), so no window or context is needed and only the CPU cost is measured.
+// Every stage reports its time, its faces per second, the allocations it made and the GL calls it issued.
+
+extern core_data CORE;
+
+#define BENCH_SEED 1337
+#define BENCH_BATCH_QUADS 4096
+#define BENCH_ARENA_VERTICES (1 << 16) // Small on purpose, growing the arena is part of the upload stage
+
+typedef struct {
+    int width; // In chunks, along X and Z
+    int height; // In chunks, along Y
+} bench_world_size;
+
+static const bench_world_size bench_world_sizes[] = {
+    { 2, 2 },
+    { 4, 2 },
+    { 8, 2 },
+    { 16, 2 },
+};
+
+typedef struct {
+    chunk** chunks;
+    GLuint chunks_count;
+    bench_world_size size;
+} bench_world;
+
+typedef struct {
+    double start;
+    bench_memory_stats memory;
+    bench_gl_stats gl;
+} bench_stage;
+
+static chunk* GetBenchWorldChunk(bench_world* world, int x, int y, int z) {
+    if(x < 0 || y < 0 || z < 0 || x >= world->size.width || y >= world->size.height || z >= world->size.width) {
+        return NULL;
+    }
+
+    return world->chunks[x + z * world->size.width + y * world->size.width * world->size.width];
+}
+
+static bool LoadBenchWorld(bench_world* world, bench_world_size size) {
+    world->size = size;
+    world->chunks_count = size.width * size.width * size.height;
+    world->chunks = (chunk**) SDL_calloc(world->chunks_count, sizeof(chunk*));
+    if(!world->chunks) {
+        return false;
+    }
+
+    for(int y = 0; y < size.height; y++) {
+        for(int z = 0; z < size.width; z++) {
+            for(int x = 0; x < size.width; x++) {
+                chunk* chunk = LoadChunk((ivec3) { x, y, z });
+                if(!chunk) {
+                    return false;
+                }
+
+                world->chunks[x + z * size.width + y * size.width * size.width] = chunk;
+            }
+        }
+    }
+
+    // Link the neighbours, so the borders between chunks are culled like the inside of a chunk
+    for(int y = 0; y < size.height; y++) {
+        for(int z = 0; z < size.width; z++) {
+            for(int x = 0; x < size.width; x++) {
+                chunk* chunk = GetBenchWorldChunk(world, x, y, z);
+
+                chunk->neighbours[VOXEL_FACE_TOP] = GetBenchWorldChunk(world, x, y + 1, z);
+                chunk->neighbours[VOXEL_FACE_DOWN] = GetBenchWorldChunk(world, x, y - 1, z);
+                chunk->neighbours[VOXEL_FACE_FRONT] = GetBenchWorldChunk(world, x, y, z + 1);
+                chunk->neighbours[VOXEL_FACE_BACK] = GetBenchWorldChunk(world, x, y, z - 1);
+                chunk->neighbours[VOXEL_FACE_LEFT] = GetBenchWorldChunk(world, x - 1, y, z);
+                chunk->neighbours[VOXEL_FACE_RIGHT] = GetBenchWorldChunk(world, x + 1, y, z);
+            }
+        }
+    }
+
+    return true;
+}
+
+static void UnloadBenchWorld(bench_world* world) {
+    for(GLuint index = 0; index < world->chunks_count; index++) {
+        if(world->chunks[index]) {
+            UnloadChunk(world->chunks[index]);
+        }
+    }
+
+    SDL_free(world->chunks);
+    *world = (bench_world) { 0 };
+}
+
+static GLuint GetBenchWorldFaces(bench_world* world, bool gpu) {
+    GLuint faces = 0;
+
+    for(GLuint index = 0; index < world->chunks_count; index++) {
+        faces += (gpu ? world->chunks[index]->gpu.indices_count : world->chunks[index]->mesh.indices_count) / 6;
+    }
+
+    return faces;
+}
+
+static void BeginBenchStage(bench_stage* stage) {
+    ResetBenchMemoryStats();
+    ResetBenchGLStats();
+
+    stage->start = GetBenchTime();
+}
+
+static void EndBenchStage(bench_stage* stage, const char* name, GLuint faces) {
+    double seconds = GetBenchTime() - stage->start;
+
+    stage->memory = GetBenchMemoryStats();
+    stage->gl = GetBenchGLStats();
+
+    printf(
+        "  %-9s | %10.2f %10u %10.2f | %8u %10.1f | %8u %6u %10.1f\n",
+        name,
+        seconds * 1e3, faces, seconds > 0.0 ? faces / seconds / 1e6 : 0.0,
+        stage->memory.allocations, stage->memory.bytes / 1024.0,
+        stage->gl.calls, stage->gl.draw_calls, stage->gl.bytes_uploaded / 1024.0
+    );
+}
+
+static void PrintBenchVoxels(bench_world* world) {
+    size_t bytes = 0;
+    GLuint uniform = 0;
+
+    for(GLuint index = 0; index < world->chunks_count; index++) {
+        bytes += sizeof(chunk) + GetChunkStorageBytes(&world->chunks[index]->voxels);
+        uniform += world->chunks[index]->voxels.bits == 0;
+    }
+
+    printf(
+        "  voxels          : %.1f KiB palette-packed, %.1f KiB dense | %u of %u chunks uniform\n",
+        bytes / 1024.0, (double) world->chunks_count * CHUNK_VOLUME / 1024.0, uniform, world->chunks_count
+    );
+}
+
+static void PrintBenchArena(const char* name) {
+    gpu_allocator_stats vertices = GetGpuAllocatorStats(&CORE.chunk_arena.vertices);
+    gpu_allocator_stats indices = GetGpuAllocatorStats(&CORE.chunk_arena.indices);
+
+    printf(
+        "  arena %-9s: live %.1f KiB, wasted %.1f KiB, capacity %.1f KiB | %u ranges, %u allocated, %u freed | %u compactions, %u grows\n",
+        name,
+        (vertices.live_bytes + indices.live_bytes) / 1024.0, (vertices.wasted_bytes + indices.wasted_bytes) / 1024.0, (vertices.capacity_bytes + indices.capacity_bytes) / 1024.0,
+        vertices.allocations_count + indices.allocations_count, vertices.allocations_total + indices.allocations_total, vertices.frees_total + indices.frees_total,
+        vertices.compactions + indices.compactions, vertices.grows + indices.grows
+    );
+}
+
+// The immediate-mode path: every visible face goes through RenderVoxel into the render batch
+static GLuint FillBenchBatch(bench_world* world) {
+    GLuint faces = 0;
+    vec4 color;
+
+    for(GLuint index = 0; index < world->chunks_count; index++) {
+        chunk* chunk = world->chunks[index];
+
+        for(int y = 0; y < CHUNK_SIZE; y++) {
+            for(int z = 0; z < CHUNK_SIZE; z++) {
+                for(int x = 0; x < CHUNK_SIZE; x++) {
+                    GLubyte type = GetChunkVoxel(chunk, x, y, z);
+                    if(type == VOXEL_AIR) {
+                        continue;
+                    }
+
+                    bool draw_face[VOXEL_FACE_COUNT] = {
+                        GetChunkVoxel(chunk, x, y + 1, z) == VOXEL_AIR,
+                        GetChunkVoxel(chunk, x, y - 1, z) == VOXEL_AIR,
+                        GetChunkVoxel(chunk, x, y, z + 1) == VOXEL_AIR,
+                        GetChunkVoxel(chunk, x, y, z - 1) == VOXEL_AIR,
+                        GetChunkVoxel(chunk, x - 1, y, z) == VOXEL_AIR,
+                        GetChunkVoxel(chunk, x + 1, y, z) == VOXEL_AIR,
+                    };
+
+                    for(int face = 0; face < VOXEL_FACE_COUNT; face++) {
+                        faces += draw_face[face];
+                    }
+
+                    vec3 position = {
+                        (chunk->position[0] * CHUNK_SIZE + x) * VOXEL_SIZE,
+                        (chunk->position[1] * CHUNK_SIZE + y + 1) * VOXEL_SIZE,
+                        (chunk->position[2] * CHUNK_SIZE + z) * VOXEL_SIZE
+                    };
+
+                    GetVoxelColor(type, color);
+                    RenderVoxel(position, VOXEL_SIZE, color, draw_face[0], draw_face[1], draw_face[2], draw_face[3], draw_face[4], draw_face[5]);
+                }
+            }
+        }
+    }
+
+    DrawRenderBatch();
+
+    return faces;
+}
+
+static void RunBenchWorld(bench_world_size size) {
+    bench_world world = { 0 };
+    bench_stage stage = { 0 };
+
+    BeginBenchStage(&stage);
+    if(!LoadBenchWorld(&world, size)) {
+        fprintf(stderr, "[ERR] BENCH: Could not allocate the world\n");
+        UnloadBenchWorld(&world);
+
+        return;
+    }
+
+    for(GLuint index = 0; index < world.chunks_count; index++) {
+        FillBenchTerrain(world.chunks[index], BENCH_SEED);
+    }
+    EndBenchStage(&stage, "generate", 0);
+    PrintBenchVoxels(&world);
+
+    // Face culling alone is the naive mesher: one quad per visible face
+    BeginBenchStage(&stage);
+    for(GLuint index = 0; index < world.chunks_count; index++) {
+        world.chunks[index]->mesh_mode = CHUNK_MESH_NAIVE;
+        BuildChunkMesh(world.chunks[index]);
+    }
+    EndBenchStage(&stage, "cull", GetBenchWorldFaces(&world, false));
+
+    BeginBenchStage(&stage);
+    for(GLuint index = 0; index < world.chunks_count; index++) {
+        world.chunks[index]->mesh_mode = CHUNK_MESH_GREEDY;
+        BuildChunkMesh(world.chunks[index]);
+    }
+    EndBenchStage(&stage, "greedy", GetBenchWorldFaces(&world, false));
+
+    BeginBenchStage(&stage);
+    for(GLuint index = 0; index < world.chunks_count; index++) {
+        UploadChunkMesh(world.chunks[index]);
+    }
+    EndBenchStage(&stage, "upload", GetBenchWorldFaces(&world, true));
+
+    // Same greedy meshing and upload, spread over the workers; the completions run on this thread
+    BeginBenchStage(&stage);
+    for(GLuint index = 0; index < world.chunks_count; index++) {
+        while(!ScheduleChunkMesh(world.chunks[index])) {
+            UpdateJobs(); // Queue full, make some room
+        }
+    }
+    WaitJobs();
+    EndBenchStage(&stage, "threaded", GetBenchWorldFaces(&world, true));
+
+    // The frustum is left zeroed, which keeps every chunk
+    BeginBenchStage(&stage);
+    for(GLuint index = 0; index < world.chunks_count; index++) {
+        RenderChunk(world.chunks[index]);
+    }
+    DrawChunkArena();
+    EndBenchStage(&stage, "draw", GetBenchWorldFaces(&world, true));
+
+    BeginBenchStage(&stage);
+    GLuint batch_faces = FillBenchBatch(&world);
+    EndBenchStage(&stage, "batch", batch_faces);
+
+    PrintBenchArena("loaded");
+    UnloadBenchWorld(&world);
+    PrintBenchArena("unloaded");
+}
+
+int main(int argc, char* argv[]) {
+    LoadBenchMemory();
+    LoadBenchGL();
+
+    LoadJobSystem(0);
+    LoadRenderBatch(BENCH_BATCH_QUADS, RENDER_BATCH_FLUSH);
+    LoadChunkArena(BENCH_ARENA_VERTICES, BENCH_ARENA_VERTICES / 4 * 6);
+
+    printf("seed %u, %u worker(s), batch of %u quads\n\n", BENCH_SEED, GetJobWorkersCount(), BENCH_BATCH_QUADS);
+
+    for(GLuint index = 0; index < SDL_arraysize(bench_world_sizes); index++) {
+        bench_world_size size = bench_world_sizes[index];
+
+        printf("world %dx%dx%d chunks (%d voxels)\n", size.width, size.height, size.width, size.width * size.width * size.height * CHUNK_VOLUME);
+        printf("  %-9s | %10s %10s %10s | %8s %10s | %8s %6s %10s\n", "stage", "ms", "faces", "Mfaces/s", "allocs", "alloc KiB", "gl calls", "draws", "upload KiB");
+        printf("  ----------+----------------------------------+---------------------+---------------------------\n");
+
+        RunBenchWorld(size);
+
+        printf("\n");
+    }
+
+    UnloadChunkArena();
+    UnloadRenderBatch();
+    UnloadJobSystem();
+
+    return 0;
+}
@@ -0,0 +1,210 @@
+#include <stdio.h>
+
+#include "SDL2/SDL.h"
+
+#include "bench.h"
+#include "chunk.h"
+#include "region.h"
+#include "terrain.h"
+
+#if !defined (_WIN32)
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+// Measures the region files: saving generated terrain (the time the main thread spends queueing it, and the time
+// until the writer thread has it on the disk), then loading it back with the files evicted from the page cache (cold)
+// and with the regions already mapped (warm). The loaded voxels must match.
+
+#define BENCH_SEED 1337
+#define BENCH_WIDTH 16 // In chunks, along X and Z, centered on the origin so it spans four regions
+#define BENCH_HEIGHT 4 // In chunks, along Y
+#define BENCH_CHUNKS (BENCH_WIDTH * BENCH_WIDTH * BENCH_HEIGHT)
+#define BENCH_DIRECTORY "bench_regions"
+
+static void GetBenchChunkPosition(GLuint index, int position[3]) {
+    position[0] = index % BENCH_WIDTH - BENCH_WIDTH / 2;
+    position[1] = index / (BENCH_WIDTH * BENCH_WIDTH);
+    position[2] = index / BENCH_WIDTH % BENCH_WIDTH - BENCH_WIDTH / 2;
+}
+
+// FNV-1a over every voxel of every chunk
+static GLuint HashBenchChunks(chunk** chunks, GLubyte* voxels) {
+    GLuint hash = 2166136261u;
+
+    for(GLuint index = 0; index < BENCH_CHUNKS; index++) {
+        DecodeChunkStorage(&chunks[index]->voxels, 0, CHUNK_VOLUME, voxels);
+
+        for(GLuint voxel = 0; voxel < CHUNK_VOLUME; voxel++) {
+            hash = (hash ^ voxels[voxel]) * 16777619u;
+        }
+    }
+
+    return hash;
+}
+
+// Calls 'function' with the path of every region the bench touches
+static void ForEachBenchRegion(void (*function)(const char* path)) {
+    for(int z = -1; z <= 0; z++) {
+        for(int x = -1; x <= 0; x++) {
+            char path[REGION_PATH_MAX];
+            if(GetRegionPath(BENCH_DIRECTORY, (int[3]) { x, 0, z }, path)) {
+                function(path);
+            }
+        }
+    }
+}
+
+// Drops the file from the page cache, so the next read has to go to the disk
+static void EvictBenchRegion(const char* path) {
+#if !defined (_WIN32)
+    int descriptor = open(path, O_RDONLY);
+    if(descriptor < 0) {
+        return;
+    }
+
+    fdatasync(descriptor);
+    posix_fadvise(descriptor, 0, 0, POSIX_FADV_DONTNEED);
+    close(descriptor);
+#else
+    (void) path;
+#endif
+}
+
+static void RemoveBenchRegion(const char* path) {
+    remove(path);
+}
+
+static size_t bench_file_bytes = 0;
+
+static void MeasureBenchRegion(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if(!file) {
+        return;
+    }
+
+    fseek(file, 0, SEEK_END);
+    bench_file_bytes += (size_t) ftell(file);
+    fclose(file);
+}
+
+static bool LoadBenchChunks(region_store* store, chunk** chunks) {
+    for(GLuint index = 0; index < BENCH_CHUNKS; index++) {
+        if(!ReadRegionChunk(store, chunks[index])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void PrintBenchRow(const char* pass, double seconds, size_t bytes, GLuint mappings) {
+    printf("%-6s | %10.2f %10.1f %10.1f | %8u\n", pass, seconds * 1e3, BENCH_CHUNKS / seconds, bytes / seconds / (1024.0 * 1024.0), mappings);
+}
+
+int main(int argc, char* argv[]) {
+    GLubyte* voxels = (GLubyte*) SDL_malloc(CHUNK_VOLUME);
+    chunk** chunks = (chunk**) SDL_calloc(BENCH_CHUNKS, sizeof(chunk*));
+    if(!voxels || !chunks) {
+        return 1;
+    }
+
+    terrain_settings settings = GetDefaultTerrainSettings(BENCH_SEED);
+
+    for(GLuint index = 0; index < BENCH_CHUNKS; index++) {
+        int position[3];
+        GetBenchChunkPosition(index, position);
+
+        chunks[index] = LoadChunk((ivec3) { position[0], position[1], position[2] });
+        if(!chunks[index]) {
+            return 1;
+        }
+
+        GenerateChunk(chunks[index], GenerateTerrain, &settings);
+    }
+
+    GLuint hash_reference = HashBenchChunks(chunks, voxels);
+
+    region_store store;
+    if(!LoadRegionStore(&store, BENCH_DIRECTORY)) {
+        return 1;
+    }
+
+    ForEachBenchRegion(RemoveBenchRegion);
+
+    printf("\nseed %u, %dx%dx%d chunks, %u bytes per chunk uncompressed\n\n", BENCH_SEED, BENCH_WIDTH, BENCH_HEIGHT, BENCH_WIDTH, CHUNK_VOLUME);
+    printf("%-6s | %10s %10s %10s | %8s\n", "pass", "ms", "chunks/s", "MB/s", "mappings");
+    printf("-------+----------------------------------+---------\n");
+
+    // Save: the main thread only snapshots the voxels, the writer thread compresses and writes them
+    double start = GetBenchTime();
+
+    for(GLuint index = 0; index < BENCH_CHUNKS; index++) {
+        if(!QueueRegionChunk(&store, chunks[index])) {
+            return 1;
+        }
+    }
+
+    double queued = GetBenchTime();
+    PrintBenchRow("queue", queued - start, 0, 0);
+
+    FlushRegionStore(&store);
+    region_stats stats = GetRegionStoreStats(&store);
+    PrintBenchRow("flush", GetBenchTime() - start, stats.bytes_written, stats.mappings);
+
+    size_t bytes_written = stats.bytes_written;
+    GLuint batches_written = stats.batches_written;
+    UnloadRegionStore(&store);
+
+    for(GLuint index = 0; index < BENCH_CHUNKS; index++) {
+        FillChunk(chunks[index], VOXEL_AIR);
+    }
+
+    // Cold: fresh store, nothing in the page cache
+    ForEachBenchRegion(EvictBenchRegion);
+    LoadRegionStore(&store, BENCH_DIRECTORY);
+
+    start = GetBenchTime();
+    bool loaded = LoadBenchChunks(&store, chunks);
+    double seconds = GetBenchTime() - start;
+
+    region_stats stats_cold = GetRegionStoreStats(&store);
+    PrintBenchRow("cold", seconds, stats_cold.bytes_read, stats_cold.mappings);
+
+    bool identical = loaded && HashBenchChunks(chunks, voxels) == hash_reference;
+
+    // Warm: same store, the regions are still mapped
+    for(GLuint index = 0; index < BENCH_CHUNKS; index++) {
+        FillChunk(chunks[index], VOXEL_AIR);
+    }
+
+    start = GetBenchTime();
+    loaded = LoadBenchChunks(&store, chunks);
+    seconds = GetBenchTime() - start;
+
+    region_stats stats_warm = GetRegionStoreStats(&store);
+    PrintBenchRow("warm", seconds, stats_warm.bytes_read - stats_cold.bytes_read, stats_warm.mappings - stats_cold.mappings);
+
+    identical &= loaded && HashBenchChunks(chunks, voxels) == hash_reference;
+
+    printf("-------+----------------------------------+---------\n");
+
+    ForEachBenchRegion(MeasureBenchRegion);
+
+    printf("\npayloads: %zu bytes, %.1f bytes per chunk, %.1fx smaller\n", bytes_written, (double) bytes_written / BENCH_CHUNKS, (double) BENCH_CHUNKS * CHUNK_VOLUME / bytes_written);
+    printf("files:    %zu bytes, %.1fx smaller (headers and sector padding included)\n", bench_file_bytes, (double) BENCH_CHUNKS * CHUNK_VOLUME / bench_file_bytes);
+    printf("written in %u batches\n", batches_written);
+    printf("identical voxels after loading: %s\n", identical ? "yes" : "NO");
+
+    UnloadRegionStore(&store);
+    ForEachBenchRegion(RemoveBenchRegion);
+
+    for(GLuint index = 0; index < BENCH_CHUNKS; index++) {
+        UnloadChunk(chunks[index]);
+    }
+
+    SDL_free(chunks);
+    SDL_free(voxels);
+
+    return identical ? 0 : 1;
+}
@@ -0,0 +1,76 @@
+#include <stdio.h>
+
+#include "SDL2/SDL.h"
+
+#include "bench.h"
+#include "core.h"
+#include "render_batch.h"
+#include "voxel.h"
+
+// Measures the CPU cost of filling the render batch with voxel faces.
+// Pushing a face must be constant time, so the time per index has to stay flat as the batch grows.
+// Both overflow policies start from the same small batch, to compare flushes against memory.
+
+extern core_data CORE;
+
+#define BENCH_QUADS_MIN 1024
+#define BENCH_QUADS_MAX (1024 * 1024)
+#define BENCH_BATCH_QUADS 1024
+
+static const char* bench_policy_names[] = {
+    "flush",
+    "grow",
+};
+
+int main(int argc, char* argv[]) {
+    LoadBenchGL();
+
+    vec3 positions[4];
+    GetVoxelFaceVertices((vec3) { 0.0f, 0.0f, 0.0f }, VOXEL_SIZE, VOXEL_FACE_TOP, positions);
+
+    vec4 colors[4] = {
+        { 1.0f, 1.0f, 1.0f, 1.0f },
+        { 1.0f, 1.0f, 1.0f, 1.0f },
+        { 1.0f, 1.0f, 1.0f, 1.0f },
+        { 1.0f, 1.0f, 1.0f, 1.0f },
+    };
+
+    vec2 texcoords[4] = {
+        { 0.0f, 0.0f },
+        { 1.0f, 0.0f },
+        { 0.0f, 1.0f },
+        { 1.0f, 1.0f },
+    };
+
+    GLuint* index_data = (GLuint*) GetVoxelFaceIndices(VOXEL_FACE_TOP);
+
+    printf("%-6s %10s %12s %12s %12s %14s %8s %10s\n", "policy", "quads", "indices", "fill ms", "ns / index", "Mindices / s", "flushes", "batch KiB");
+
+    for(int policy = RENDER_BATCH_FLUSH; policy <= RENDER_BATCH_GROW; policy++) {
+        for(GLuint quads = BENCH_QUADS_MIN; quads <= BENCH_QUADS_MAX; quads *= 4) {
+            LoadRenderBatch(BENCH_BATCH_QUADS, policy);
+
+            double start = GetBenchTime();
+            for(GLuint quad = 0; quad < quads; quad++) {
+                PushRenderBatchVertexData(positions, colors, texcoords, 0, 4);
+                PushRenderBatchIndexData(index_data, 6);
+            }
+            double seconds = GetBenchTime() - start;
+
+            DrawRenderBatch();
+
+            GLuint indices = quads * 6;
+            GLuint batch_bytes = CORE.render_batch.vertices_count_max * sizeof(vert) + CORE.render_batch.indices_count_max * sizeof(GLuint);
+
+            printf(
+                "%-6s %10u %12u %12.3f %12.2f %14.1f %8u %10u\n",
+                bench_policy_names[policy], quads, indices, seconds * 1e3, seconds * 1e9 / indices, indices / seconds / 1e6,
+                CORE.render_batch.flush_count, batch_bytes / 1024
+            );
+
+            UnloadRenderBatch();
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,142 @@
+#include <stdio.h>
+
+#include "SDL2/SDL.h"
+
+#include "bench.h"
+#include "chunk.h"
+#include "job.h"
+#include "terrain.h"
+
+// Measures the terrain generator: every noise kernel on a single thread, then the fastest one spread
+// over a growing number of workers. Every run must generate the exact same voxels, which is checked too.
+
+#define BENCH_SEED 1337
+#define BENCH_WIDTH 8 // In chunks, along X and Z
+#define BENCH_HEIGHT 4 // In chunks, along Y
+#define BENCH_CHUNKS (BENCH_WIDTH * BENCH_WIDTH * BENCH_HEIGHT)
+
+static void GetBenchChunkPosition(GLuint index, int position[3]) {
+    position[0] = index % BENCH_WIDTH;
+    position[1] = index / (BENCH_WIDTH * BENCH_WIDTH);
+    position[2] = index / BENCH_WIDTH % BENCH_WIDTH;
+}
+
+// FNV-1a over every generated voxel
+static GLuint HashBenchVoxels(GLuint hash, const GLubyte* voxels) {
+    for(GLuint index = 0; index < CHUNK_VOLUME; index++) {
+        hash = (hash ^ voxels[index]) * 16777619u;
+    }
+
+    return hash;
+}
+
+static void PrintBenchRow(const char* kernel, GLuint workers, double seconds, GLuint hash) {
+    double chunks_per_second = BENCH_CHUNKS / seconds;
+
+    printf("%-8s | %7u | %10.2f %10.1f %12.1f | %08x\n", kernel, workers, seconds * 1e3, chunks_per_second, chunks_per_second / workers, hash);
+}
+
+int main(int argc, char* argv[]) {
+    GLubyte* voxels = (GLubyte*) SDL_malloc(CHUNK_VOLUME);
+    chunk** chunks = (chunk**) SDL_calloc(BENCH_CHUNKS, sizeof(chunk*));
+    if(!voxels || !chunks) {
+        return 1;
+    }
+
+    terrain_settings settings = GetDefaultTerrainSettings(BENCH_SEED);
+
+    printf("seed %u, %dx%dx%d chunks, %u cores\n\n", BENCH_SEED, BENCH_WIDTH, BENCH_HEIGHT, BENCH_WIDTH, SDL_GetCPUCount());
+    printf("%-8s | %7s | %10s %10s %12s | %8s\n", "kernel", "workers", "ms", "chunks/s", "chunks/s/core", "voxels");
+    printf("---------+---------+-------------------------------------+---------\n");
+
+    GLuint hash_reference = 0;
+    bool identical = true;
+
+    for(int kernel = 0; kernel < TERRAIN_KERNEL_COUNT; kernel++) {
+        if(!IsTerrainKernelSupported(kernel)) {
+            printf("%-8s | not supported by this CPU\n", GetTerrainKernelName(kernel));
+
+            continue;
+        }
+
+        settings.kernel = kernel;
+
+        GLuint hash = 2166136261u;
+        double start = GetBenchTime();
+
+        for(GLuint index = 0; index < BENCH_CHUNKS; index++) {
+            int position[3];
+            GetBenchChunkPosition(index, position);
+
+            GenerateTerrain(&settings, position, voxels);
+            hash = HashBenchVoxels(hash, voxels);
+        }
+
+        PrintBenchRow(GetTerrainKernelName(kernel), 1, GetBenchTime() - start, hash);
+
+        if(kernel == TERRAIN_KERNEL_SCALAR) {
+            hash_reference = hash;
+        } else {
+            identical &= hash == hash_reference;
+        }
+    }
+
+    printf("---------+---------+-------------------------------------+---------\n");
+
+    // Threaded, through the chunks: includes the palette encoding done on the main thread
+    settings = GetDefaultTerrainSettings(BENCH_SEED);
+
+    for(GLuint index = 0; index < BENCH_CHUNKS; index++) {
+        int position[3];
+        GetBenchChunkPosition(index, position);
+
+        chunks[index] = LoadChunk((ivec3) { position[0], position[1], position[2] });
+        if(!chunks[index]) {
+            return 1;
+        }
+    }
+
+    GLuint workers_max = SDL_max(SDL_GetCPUCount() - 1, 1);
+
+    for(GLuint workers = 1; ; workers = SDL_min(workers * 2, workers_max)) {
+        LoadJobSystem(workers);
+
+        double start = GetBenchTime();
+
+        for(GLuint index = 0; index < BENCH_CHUNKS; index++) {
+            while(!ScheduleChunkGenerate(chunks[index], GenerateTerrain, &settings)) {
+                UpdateJobs(); // Queue full, make some room
+            }
+        }
+
+        WaitJobs();
+
+        double seconds = GetBenchTime() - start;
+
+        GLuint hash = 2166136261u;
+        for(GLuint index = 0; index < BENCH_CHUNKS; index++) {
+            DecodeChunkStorage(&chunks[index]->voxels, 0, CHUNK_VOLUME, voxels);
+            hash = HashBenchVoxels(hash, voxels);
+        }
+
+        PrintBenchRow(GetTerrainKernelName(settings.kernel), GetJobWorkersCount(), seconds, hash);
+        identical &= hash == hash_reference;
+
+        UnloadJobSystem();
+
+        if(workers == workers_max) {
+            break;
+        }
+    }
+
+    printf("\nidentical voxels in every run: %s\n", identical ? "yes" : "NO");
+
+    for(GLuint index = 0; index < BENCH_CHUNKS; index++) {
+        UnloadChunk(chunks[index]);
+    }
+
+    SDL_free(chunks);
+    SDL_free(voxels);
+
+    return identical ? 0 : 1;
+}
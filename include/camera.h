@@ -29,6 +29,9 @@ typedef struct {
     // View-Projection matrices, later-on pushed to the shader
     mat4 projection;
     mat4 view;
+
+    // Frustum planes (left, right, bottom, top, near, far) extracted from projection * view
+    vec4 frustum[6];
 } camera;
 
 camera CameraInit(camera_mode mode, vec3 position, GLfloat field_of_view);
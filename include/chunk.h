@@ -0,0 +1,123 @@
+#if !defined (CHUNK_H)
+#define CHUNK_H
+
+#include <stdbool.h>
+
+#include "glad/glad.h"
+#include "cglm/types.h"
+
+#include "chunk_storage.h"
+#include "light.h"
+#include "voxel.h"
+
+#define CHUNK_SIZE 32
+#define CHUNK_VOLUME (CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE)
+
+// Voxels are stored Y-major, so every horizontal slice of the chunk is contiguous
+#define CHUNK_INDEX(x, y, z) ((x) + (z) * CHUNK_SIZE + (y) * CHUNK_SIZE * CHUNK_SIZE)
+
+typedef enum {
+    CHUNK_MESH_NAIVE, // One quad per visible voxel face
+    CHUNK_MESH_GREEDY // Coplanar faces of the same voxel type, ambient occlusion and light merged into larger quads
+} chunk_mesh_mode;
+
+// Levels of detail: level N meshes cells of 2^N voxels per side, downsampled from the voxels
+#define CHUNK_LOD_COUNT 4
+#define CHUNK_LOD_SCALE_MAX (1 << (CHUNK_LOD_COUNT - 1))
+
+// Snapshot of a chunk with a one voxel border copied from its neighbours, used by the mesher
+#define CHUNK_PADDED_SIZE (CHUNK_SIZE + 2)
+#define CHUNK_PADDED_VOLUME (CHUNK_PADDED_SIZE * CHUNK_PADDED_SIZE * CHUNK_PADDED_SIZE)
+#define CHUNK_PADDED_INDEX(x, y, z) (((x) + 1) + ((z) + 1) * CHUNK_PADDED_SIZE + ((y) + 1) * CHUNK_PADDED_SIZE * CHUNK_PADDED_SIZE)
+
+// Bit layout of 'vert_packed', mirrored by res/shaders/chunk_vertex.glsl
+#define VERT_PACKED_X_SHIFT 0           // 6 bits, chunk-local 0..CHUNK_SIZE
+#define VERT_PACKED_Y_SHIFT 6           // 6 bits, chunk-local 0..CHUNK_SIZE
+#define VERT_PACKED_Z_SHIFT 12          // 6 bits, chunk-local 0..CHUNK_SIZE
+#define VERT_PACKED_FACE_SHIFT 18       // 3 bits, voxel_face (normal index)
+#define VERT_PACKED_AO_SHIFT 21         // 2 bits, ambient occlusion from the adjacent voxels, 0 (open) to 3 (fully occluded)
+#define VERT_PACKED_TYPE_SHIFT 0        // 8 bits, voxel_type (texture id)
+#define VERT_PACKED_SUNLIGHT_SHIFT 8    // 4 bits
+#define VERT_PACKED_BLOCKLIGHT_SHIFT 12 // 4 bits
+#define VERT_PACKED_SLOT_SHIFT 16       // 16 bits, chunk arena slot, filled in when the mesh is uploaded
+
+// Compact chunk vertex: 8 bytes instead of the 40 of 'vert'
+typedef struct {
+    GLuint position_face;
+    GLuint type_light;
+} vert_packed;
+
+typedef struct {
+    vert_packed* vertices; GLuint vertices_count; GLuint vertices_count_max;
+    GLuint* indices; GLuint indices_count; GLuint indices_count_max;
+} chunk_mesh;
+
+typedef struct chunk_mesh_job chunk_mesh_job;
+typedef struct chunk_generate_job chunk_generate_job;
+typedef struct chunk_light_job chunk_light_job;
+
+// Fills the CHUNK_VOLUME voxels of the chunk at 'position', runs on a worker thread
+typedef void (*chunk_generator)(const void* settings, const int position[3], GLubyte* voxels);
+
+typedef struct chunk {
+    ivec3 position; // Position in chunk units, not in world units
+
+    chunk_storage voxels; // CHUNK_VOLUME voxel_type values, palette-compressed
+    chunk_storage light; // CHUNK_VOLUME light bytes (see light.h), palette-compressed
+
+    // Adjacent chunks used for face culling on the chunk borders (NULL is treated as air)
+    struct chunk* neighbours[VOXEL_FACE_COUNT];
+
+    chunk_mesh mesh; // CPU-side mesh, released once it has been uploaded
+    chunk_mesh_mode mesh_mode;
+    GLuint lod; // Level of detail of the mesh, see CHUNK_LOD_COUNT
+    bool dirty; // The mesh no longer matches the voxels
+    bool modified; // The voxels differ from what's stored on disk (or from what the generator makes)
+
+    struct chunk_mesh_job* mesh_job; // Mesh being built on a worker thread, if any
+    struct chunk_generate_job* generate_job; // Voxels being generated on a worker thread, if any
+    struct chunk_light_job* light_job; // Light being spread on a worker thread, if any
+
+    // Changes waiting for the next light job
+    light_event* light_events; GLuint light_events_count; GLuint light_events_count_max;
+    bool light_reset; // Relight everything instead
+
+    // Retained GPU copy of the mesh in the chunk arena (see chunk_arena.h), re-uploaded only when the chunk is dirty
+    struct {
+        GLuint slot; // Holds the chunk offset, 0 until the first upload
+
+        GLuint vertices_first; GLuint vertices_count_max; // Ranges currently reserved in the arena
+        GLuint indices_first; GLuint indices_count_max;
+        GLuint indices_count;
+    } gpu;
+} chunk;
+
+chunk* LoadChunk(ivec3 position);
+void UnloadChunk(chunk* chunk);
+
+GLubyte GetChunkVoxel(chunk* chunk, int x, int y, int z);
+GLubyte GetChunkLight(chunk* chunk, int x, int y, int z); // Light byte, see light.h
+void SetChunkVoxel(chunk* chunk, int x, int y, int z, GLubyte type);
+void FillChunk(chunk* chunk, GLubyte type);
+void SetChunkVoxels(chunk* chunk, const GLubyte* voxels); // CHUNK_VOLUME voxels, in CHUNK_INDEX order
+void SetChunkLod(chunk* chunk, GLuint lod); // Remeshes the chunk and its neighbours when the level changes
+void ShrinkChunk(chunk* chunk); // Compacts the voxel storage once a batch of edits (e.g. generation) is done
+
+// Thread-safe: works on a padded snapshot (CHUNK_PADDED_VOLUME voxels) filled by CopyChunkVoxels
+void CopyChunkVoxels(chunk* chunk, GLubyte* voxels);
+void CopyChunkLight(chunk* chunk, GLubyte* light); // Padded like CopyChunkVoxels, missing neighbours are dark
+void BuildChunkMeshFromVoxels(const GLubyte* voxels, chunk_mesh_mode mode, chunk_mesh* mesh); // Lit by the open sky everywhere
+void BuildChunkLodMeshFromVoxels(const GLubyte* voxels, const GLubyte* light, chunk_mesh_mode mode, GLuint lod, GLuint seams, chunk_mesh* mesh); // 'seams' is a mask of (1 << voxel_face)
+
+void BuildChunkMesh(chunk* chunk);
+bool ScheduleChunkMesh(chunk* chunk);
+void GenerateChunk(chunk* chunk, chunk_generator generator, const void* settings);
+bool ScheduleChunkGenerate(chunk* chunk, chunk_generator generator, const void* settings); // 'settings' must outlive the job
+void UploadChunkMesh(chunk* chunk);
+void RenderChunk(chunk* chunk); // Meshes the chunk when it's dirty, then draws it
+void DrawChunk(chunk* chunk); // Draws the last uploaded mesh, if it's in the frustum
+
+void LoadChunkProgram(const GLchar* vertex_shader_filepath, const GLchar* fragment_shader_filepath);
+void UnloadChunkProgram();
+
+#endif // CHUNK_H
@@ -0,0 +1,59 @@
+#if !defined (CHUNK_ARENA_H)
+#define CHUNK_ARENA_H
+
+#include <stdbool.h>
+
+#include "glad/glad.h"
+
+#include "chunk.h"
+#include "gpu_allocator.h"
+#include "stream_buffer.h"
+
+#define CHUNK_ARENA_OFFSETS_TEXTURE_UNIT 1
+#define CHUNK_ARENA_SLOTS_MAX (1 << 16) // Slots are stored in 16 bits of 'vert_packed'
+
+// Layout of DrawElementsIndirectCommand, consumed as-is by glMultiDrawElementsIndirect
+typedef struct {
+    GLuint count;
+    GLuint instance_count;
+    GLuint first_index;
+    GLint base_vertex;
+    GLuint base_instance;
+} chunk_draw_command;
+
+// Every chunk mesh lives in one shared vertex buffer and one shared index buffer, behind a single VAO,
+// so all the visible chunks are submitted with a single multi-draw per frame.
+// Meshes get their ranges from a suballocator per buffer, which packs the buffers again once they get too fragmented.
+// The world offset of each chunk sits in a buffer texture, indexed by the slot stored in its vertices.
+typedef struct {
+    GLuint vao_id;
+    gpu_allocator vertices; // In 'vert_packed'
+    gpu_allocator indices; // In GLuint
+
+    GLuint offsets_buffer_id;
+    GLuint offsets_texture_id;
+    GLuint slots_count; GLuint slots_count_max; // Slot 0 is never handed out, it means "no slot"
+    GLuint* free_slots; GLuint free_slots_count;
+
+    // Draws queued by RenderChunk this frame. The commands are filled from the chunks when they are submitted.
+    chunk** draw_chunks;
+    chunk_draw_command* commands; GLuint commands_count; GLuint commands_count_max;
+
+    // GL_ARB_multi_draw_indirect: commands are streamed to the GPU. Otherwise they are unpacked for glMultiDrawElementsBaseVertex.
+    bool indirect;
+    stream_buffer command_stream;
+    GLsizei* draw_counts;
+    void** draw_offsets;
+    GLint* draw_base_vertices;
+} chunk_arena;
+
+bool LoadChunkArena(GLuint vertices_count, GLuint indices_count);
+void UnloadChunkArena();
+
+void WriteChunkArena(chunk* chunk); // Copies the CPU mesh of the chunk into the arena
+void ReleaseChunkArena(chunk* chunk);
+
+void QueueChunkArenaDraw(chunk* chunk); // The chunk must stay loaded until DrawChunkArena
+void DrawChunkArena(); // Submits the queued chunks, once per frame
+
+#endif // CHUNK_ARENA_H
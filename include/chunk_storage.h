@@ -0,0 +1,42 @@
+#if !defined (CHUNK_STORAGE_H)
+#define CHUNK_STORAGE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "glad/glad.h"
+
+#define CHUNK_STORAGE_PALETTE_MAX 256 // Every GLubyte voxel type fits at 8 bits per voxel
+
+// Palette-compressed voxels of a chunk.
+// A chunk made of a single voxel type is just that type. Otherwise every voxel is an index into a per-chunk palette,
+// bit-packed at 1, 2, 4 or 8 bits into 32-bit words (so an index never straddles two words).
+// The indices are widened as the palette grows; ShrinkChunkStorage narrows them again once types are gone.
+typedef struct {
+    GLuint bits; // Per voxel, 0 while the chunk is uniform
+    GLuint palette_count;
+    GLubyte palette[CHUNK_STORAGE_PALETTE_MAX];
+    GLuint* indices; // 'count * bits / 32' words, NULL while the chunk is uniform
+    GLuint count; // Voxels, a multiple of 32
+} chunk_storage;
+
+bool LoadChunkStorage(chunk_storage* storage, GLuint count, GLubyte type);
+void UnloadChunkStorage(chunk_storage* storage);
+bool CopyChunkStorage(chunk_storage* destination, const chunk_storage* source); // 'destination' must not be loaded
+
+GLubyte GetChunkStorageVoxel(const chunk_storage* storage, GLuint index);
+bool SetChunkStorageVoxel(chunk_storage* storage, GLuint index, GLubyte type); // false if the indices couldn't be widened
+void FillChunkStorage(chunk_storage* storage, GLubyte type);
+
+// Replaces every voxel at once from 'count' dense voxel types, with the smallest palette that holds them
+bool EncodeChunkStorage(chunk_storage* storage, const GLubyte* voxels);
+
+// Expands 'count' voxels starting at 'first' into 'voxels', both multiples of 32
+void DecodeChunkStorage(const chunk_storage* storage, GLuint first, GLuint count, GLubyte* voxels);
+
+// Drops the palette entries no voxel uses anymore and narrows the indices to match
+void ShrinkChunkStorage(chunk_storage* storage);
+
+size_t GetChunkStorageBytes(const chunk_storage* storage); // Heap memory used by the indices
+
+#endif // CHUNK_STORAGE_H
@@ -6,7 +6,32 @@
 #include "cglm/types.h"
 
 #include "camera.h"
+#include "chunk_arena.h"
+#include "job.h"
 #include "render_batch.h"
+#include "render_state.h"
+#include "shader.h"
+#include "stream_buffer.h"
+
+typedef struct {
+    GLuint chunks_tested;
+    GLuint chunks_culled; // Outside of the view frustum
+    GLuint chunks_drawn;
+
+    GLuint gl_calls_issued; // State changes that reached OpenGL
+    GLuint gl_calls_filtered; // State changes dropped by the state cache, the context already had them
+} render_stats;
+
+// Mirrors the std140 layout of the "FrameData" uniform block, see res/shaders/vertex.glsl
+typedef struct {
+    mat4 view;
+    mat4 projection;
+    mat4 view_projection;
+    vec4 camera_position; // W is unused
+    vec2 viewport_size;
+    GLfloat time; // Seconds since the window was created
+    GLfloat padding;
+} frame_uniforms;
 
 typedef struct {
     struct {
@@ -36,24 +61,61 @@ typedef struct {
         GLuint shader_vertex_id;
         GLuint shader_fragment_id;
 
-        GLuint shader_program_id;
+        shader_program shader_program;
+
+        shader_program chunk_program; // Draws chunk meshes made of 'vert_packed'
     } shaders;
 
     struct {
         GLuint vao_id;
-        GLuint vbo_id;
-        GLuint ebo_id;
+
+        // Flushed geometry is streamed, a flush never reallocates or waits on the previous draws
+        stream_buffer vertex_stream;
+        stream_buffer index_stream;
 
         vert* vertices; GLuint vertices_count; GLuint vertices_count_max;
         GLuint* indices; GLuint indices_count; GLuint indices_count_max;
+
+        GLuint indices_base; // First vertex the next pushed indices are relative to
+
+        render_batch_policy policy;
+        GLuint flush_count; // Draw calls issued by the batch since it was loaded
     } render_batch;
 
     struct {
-        mat4 projection;    GLuint shader_loc_projection;
-        mat4 view;          GLuint shader_loc_view;
-        mat4 model;         GLuint shader_loc_model;
+        // The uniform locations live in each program (see shader_program.locs)
+        mat4 projection;
+        mat4 view;
+        mat4 model;
+
+        vec4 frustum[6]; // Planes of the active camera, chunks outside of them are skipped
     } matrices;
 
+    struct {
+        GLuint ubo_id; // Bound to SHADER_FRAME_BINDING for the lifetime of the context
+        frame_uniforms data;
+    } frame;
+
+    struct {
+        SDL_Thread** workers; GLuint workers_count;
+
+        job_queue queue; // Main thread -> workers
+        job_queue completed; // Workers -> main thread
+        SDL_sem* queue_semaphore; // Counts the jobs waiting in 'queue'
+
+        SDL_atomic_t pending; // Pushed, but not completed on the main thread yet
+        SDL_atomic_t quit;
+    } jobs;
+
+    chunk_arena chunk_arena;
+
+    render_state render_state;
+
+    struct {
+        render_stats current;
+        render_stats previous; // Last completed frame
+    } stats;
+
 } core_data;
 
 void CreateWindow(ivec2 size, const GLchar* title);
@@ -69,4 +131,9 @@ void EndRenderMode();
 
 void DefaultMatrix();
 
+// Fills the per-frame uniform block shared by every program, with a single upload
+void UpdateFrameUniforms(mat4 projection, mat4 view, vec3 camera_position);
+
+render_stats GetRenderStats();
+
 #endif // CORE_H
\ No newline at end of file
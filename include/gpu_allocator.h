@@ -0,0 +1,64 @@
+#if !defined (GPU_ALLOCATOR_H)
+#define GPU_ALLOCATOR_H
+
+#include <stdbool.h>
+
+#include "glad/glad.h"
+
+#define GPU_ALLOCATOR_COMPACT_THRESHOLD 0.25f // Share of the buffer lost in holes that triggers a compaction
+
+typedef struct {
+    GLuint offset; // In elements
+    GLuint size;
+} gpu_range;
+
+typedef struct {
+    GLuint offset;
+    GLuint size;
+    GLuint* owner; // Receives the new offset when the allocation is moved
+} gpu_allocation;
+
+typedef struct {
+    GLsizeiptr live_bytes;
+    GLsizeiptr wasted_bytes; // Free space in holes between allocations, the free tail of the buffer isn't counted
+    GLsizeiptr capacity_bytes;
+
+    GLuint allocations_count; // Live
+    GLuint allocations_total;
+    GLuint frees_total;
+    GLuint compactions;
+    GLuint grows;
+} gpu_allocator_stats;
+
+// Suballocates ranges of elements out of a single large buffer.
+// Free ranges are kept sorted and coalesced, allocations are first-fit.
+// When the holes waste too much space, the next allocation packs the live ranges into a new buffer
+// on the GPU and tells their owners their new offsets. So does any allocation that doesn't fit anymore.
+typedef struct {
+    GLuint buffer_id; // Replaced by compactions and growth
+    GLsizeiptr element_size;
+    GLuint capacity; // In elements
+
+    gpu_range* free_ranges; GLuint free_ranges_count; GLuint free_ranges_count_max;
+    gpu_allocation* allocations; GLuint allocations_count; GLuint allocations_count_max; // Sorted by offset
+
+    GLuint live; // Elements in use
+    bool compact_pending; // The holes went past GPU_ALLOCATOR_COMPACT_THRESHOLD since the last compaction
+    GLuint allocations_total;
+    GLuint frees_total;
+    GLuint compactions;
+    GLuint grows;
+} gpu_allocator;
+
+bool LoadGpuAllocator(gpu_allocator* allocator, GLsizeiptr element_size, GLuint capacity);
+void UnloadGpuAllocator(gpu_allocator* allocator);
+
+// Writes the offset of the new range to '*owner', which must stay valid until the range is freed
+bool AllocateGpuRange(gpu_allocator* allocator, GLuint size, GLuint* owner);
+void FreeGpuRange(gpu_allocator* allocator, GLuint* owner);
+
+void CompactGpuAllocator(gpu_allocator* allocator);
+
+gpu_allocator_stats GetGpuAllocatorStats(const gpu_allocator* allocator);
+
+#endif // GPU_ALLOCATOR_H
@@ -0,0 +1,42 @@
+#if !defined (JOB_H)
+#define JOB_H
+
+#include <stdbool.h>
+
+#include "SDL2/SDL.h"
+#include "glad/glad.h"
+
+#define JOB_QUEUE_CAPACITY 4096 // Must be a power of two
+
+typedef void (*job_function)(void* data);
+
+typedef struct {
+    job_function function; // Runs on a worker thread
+    job_function complete; // Runs on the main thread from UpdateJobs, may be NULL
+    void* data;
+} job;
+
+typedef struct {
+    SDL_atomic_t sequence; // Which lap of the ring the cell is ready for
+    job job;
+} job_cell;
+
+// Bounded lock-free multi-producer/multi-consumer ring of jobs
+typedef struct {
+    job_cell* cells;
+
+    GLuint mask;
+    SDL_atomic_t enqueue_position;
+    SDL_atomic_t dequeue_position;
+} job_queue;
+
+void LoadJobSystem(GLuint workers_count); // 0 spawns one worker per core, next to the main thread
+void UnloadJobSystem();
+
+bool PushJob(job job); // false when too many jobs are in flight, try again later
+void UpdateJobs(); // Runs the completion callbacks of the finished jobs
+void WaitJobs(); // Blocks until every pushed job has finished and completed
+
+GLuint GetJobWorkersCount();
+
+#endif // JOB_H
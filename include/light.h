@@ -0,0 +1,58 @@
+#if !defined (LIGHT_H)
+#define LIGHT_H
+
+#include <stdbool.h>
+
+#include "glad/glad.h"
+
+struct chunk;
+
+#define LIGHT_LEVEL_MAX 15
+
+// A light byte holds the sunlight in the high nibble and the block light in the low one
+#define LIGHT_SUN_SHIFT 4
+#define LIGHT_PACK(sun, block) ((GLubyte) (((sun) << LIGHT_SUN_SHIFT) | (block)))
+#define LIGHT_SUN(light) ((light) >> LIGHT_SUN_SHIFT)
+#define LIGHT_BLOCK(light) ((light) & 15)
+#define LIGHT_SKY LIGHT_PACK(LIGHT_LEVEL_MAX, 0) // Open sky above the world
+
+typedef enum {
+    LIGHT_CHANNEL_SUN,
+    LIGHT_CHANNEL_BLOCK
+} light_channel;
+
+typedef enum {
+    LIGHT_EVENT_VOXEL, // The voxel changed type
+    LIGHT_EVENT_ADD, // Light spreading in from a neighbour: the voxel is raised to 'level'
+    LIGHT_EVENT_REMOVE // Light of 'level' was removed next to the voxel in a neighbour: unlight it if it came from there
+} light_event_kind;
+
+// Pending change to the light of a chunk, applied by its next light job
+typedef struct {
+    GLushort index; // CHUNK_INDEX of the voxel
+    GLubyte kind; // light_event_kind
+    GLubyte channel; // light_channel
+    GLubyte level;
+    bool downward; // LIGHT_EVENT_REMOVE came from the chunk above, where sunlight doesn't fade
+} light_event;
+
+// Light spreads with a flood fill (BFS) through the transparent voxels, one level less per voxel,
+// except sunlight going straight down which keeps its level. A removal first unlights every voxel that
+// got its light from the removed one, then relights them from the brighter voxels around that area.
+//
+// Every chunk is lit by its own job, on a snapshot with the light of its neighbours' borders. Light crossing
+// into a neighbour becomes an event for that neighbour's next job, so an edit only touches the chunks the
+// change actually reaches. Adjacent chunks are never lit at the same time, so the borders stay consistent.
+
+void QueueChunkLightEvent(struct chunk* chunk, light_event event);
+void QueueChunkLightReset(struct chunk* chunk); // Every voxel changed: relights the whole chunk, replacing its pending events
+void ClearChunkLight(struct chunk* chunk); // Drops the pending events and detaches the running job, when the chunk is unloaded
+
+bool IsChunkLightPending(struct chunk* chunk); // Has events waiting for a light job
+bool CanChunkLight(struct chunk* chunk); // Neither the chunk nor an adjacent one is being lit
+
+// 'sky' lets sunlight in through the top of the chunk, for the highest chunks of the world
+void LightChunk(struct chunk* chunk, bool sky);
+bool ScheduleChunkLight(struct chunk* chunk, bool sky);
+
+#endif // LIGHT_H
@@ -0,0 +1,122 @@
+#if !defined (REGION_H)
+#define REGION_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include "SDL2/SDL.h"
+#include "glad/glad.h"
+
+#include "chunk.h"
+#include "chunk_storage.h"
+
+#define REGION_SIZE 32 // Chunks along X and Z
+#define REGION_HEIGHT 8 // Chunks along Y
+#define REGION_CHUNKS (REGION_SIZE * REGION_SIZE * REGION_HEIGHT)
+
+#define REGION_MAGIC 0x47525856u // "VXRG"
+#define REGION_VERSION 1
+#define REGION_SECTOR_SIZE 256 // Payloads start and grow in whole sectors, so a rewrite usually fits in place
+#define REGION_PATH_MAX 512
+#define REGION_DIRECTORY_MAX (REGION_PATH_MAX - 48) // Leaves room for "/r.X.Y.Z.region" with the longest coordinates
+#define REGION_CACHE_SIZE 16 // Regions kept open at the same time
+
+typedef enum {
+    REGION_CODEC_RLE = 1 // Runs of (GLushort count, GLubyte type) over the voxels in CHUNK_INDEX order
+} region_codec;
+
+// On disk, every field is little-endian
+typedef struct {
+    GLuint offset; // From the start of the file, 0 when the chunk was never stored
+    GLuint size; // Of the payload: one region_codec byte, then the compressed voxels
+} region_entry;
+
+typedef struct {
+    GLuint magic;
+    GLuint version;
+    region_entry entries[REGION_CHUNKS];
+} region_header;
+
+// A region file, mapped into memory for reading
+typedef struct {
+    bool used;
+    bool exists; // Lookups for chunks of a region that was never saved don't touch the disk again
+    int position[3]; // In regions
+    char path[REGION_PATH_MAX];
+
+    region_entry entries[REGION_CHUNKS]; // Host-endian copy of the header
+    size_t file_size;
+
+    const GLubyte* mapping; size_t mapping_size; // Dropped by writes, mapped again by the next read
+    FILE* file; // Opened for the first write
+
+    GLuint last_used;
+} region;
+
+// Snapshot of a chunk's voxels, waiting for the writer thread
+typedef struct {
+    int position[3]; // In chunks
+    chunk_storage voxels;
+} region_save;
+
+typedef struct {
+    GLuint chunks_read;
+    GLuint chunks_read_queued; // Read back from a save that wasn't written yet
+    GLuint chunks_missing; // Lookups for chunks that aren't on disk
+    GLuint chunks_queued;
+    GLuint chunks_coalesced; // Queued again before the previous save was written, replacing it
+    GLuint chunks_written;
+    GLuint batches_written;
+    size_t bytes_read; // Compressed
+    size_t bytes_written;
+    GLuint regions_opened;
+    GLuint mappings;
+} region_stats;
+
+// Chunks grouped by REGION_SIZE x REGION_HEIGHT x REGION_SIZE into files, each starting with a table of offsets to compressed payloads.
+// Reads go through a memory mapping of the file, so loading a chunk is a table lookup plus the decompression.
+// Writes are queued and done by a writer thread in batches, so saving never stalls the main thread on the disk.
+typedef struct {
+    char directory[REGION_PATH_MAX];
+    region* regions; // REGION_CACHE_SIZE of them
+    GLuint clock;
+
+    FILE** evicted; GLuint evicted_count; GLuint evicted_count_max; // Files of evicted regions, waiting to be synced
+
+    GLubyte* voxels; // Scratch for decompressing on the main thread, CHUNK_VOLUME voxels
+    GLubyte* write_voxels; // Scratch of the writer thread, CHUNK_VOLUME voxels
+    GLubyte* write_payload; // Scratch of the writer thread, large enough for the worst case
+
+    // Queued saves, oldest first. The first 'saves_writing' of them are the batch the writer is working on.
+    region_save** saves; GLuint saves_count; GLuint saves_count_max;
+    GLuint saves_writing;
+
+    SDL_Thread* writer;
+    SDL_mutex* saves_lock; // Guards the saves, 'quit' and their stats
+    SDL_mutex* regions_lock; // Guards the regions, the files and their stats
+    SDL_cond* saves_queued; // Wakes up the writer
+    SDL_cond* saves_written; // Wakes up FlushRegionStore
+    bool quit;
+
+    region_stats stats;
+} region_store;
+
+bool LoadRegionStore(region_store* store, const char* directory); // Creates the directory if needed, starts the writer thread. At most REGION_DIRECTORY_MAX long.
+void UnloadRegionStore(region_store* store); // Flushes the queued saves first
+
+// false when the chunk was never stored. A queued save of the chunk is found too, even before it's written.
+bool ReadRegionChunk(region_store* store, chunk* chunk);
+
+// Snapshots the voxels for the writer thread and clears 'modified'.
+// A chunk queued again before its last save is written only replaces that save, so it's written once.
+bool QueueRegionChunk(region_store* store, chunk* chunk);
+
+// Blocks until every queued save is written and synced to the disk
+void FlushRegionStore(region_store* store);
+
+region_stats GetRegionStoreStats(region_store* store);
+
+bool GetRegionPath(const char* directory, const int position[3], char* path); // 'position' in regions, 'path' holds REGION_PATH_MAX, false when cut off
+
+#endif // REGION_H
@@ -4,17 +4,27 @@
 #include "glad/glad.h"
 #include "cglm/types.h"
 
+// Tightly packed and interleaved exactly like the vertex attributes,
+// so arrays of 'vert' can be handed to OpenGL without any conversion
 typedef struct {
-    vec3 position;
-    vec4 color;
-    vec2 texcoord;
-    GLint texid;
+    GLfloat position[3];
+    GLfloat color[4];
+    GLfloat texcoord[2];
+    GLfloat texid;
 } vert;
 
-void LoadRenderBatch(const GLuint triangles_count);
+// What to do when a push doesn't fit in the batch anymore
+typedef enum {
+    RENDER_BATCH_FLUSH, // Draw what's in the batch and start over: fixed memory, more uploads per frame
+    RENDER_BATCH_GROW   // Double the batch storage: one upload per frame, memory grows to the peak frame
+} render_batch_policy;
+
+void LoadRenderBatch(const GLuint quads_count, render_batch_policy policy);
 void UnloadRenderBatch();
+void FlushRenderBatch();
 void DrawRenderBatch();
 void PushRenderBatchVertexData(vec3* positions, vec4* colors, vec2* texcoord, GLint texid, GLuint data_count);
+void PushRenderBatchVertices(vert* vertices, GLuint data_count);
 void PushRenderBatchIndexData(GLuint* index_data, GLuint data_count);
 
 #endif // RENDER_BATCH_H
\ No newline at end of file
@@ -0,0 +1,55 @@
+#if !defined (RENDER_STATE_H)
+#define RENDER_STATE_H
+
+#include <stdbool.h>
+
+#include "glad/glad.h"
+
+#define RENDER_STATE_VERTEX_ATTRIBS_MAX 16
+
+// A value the context is known to hold; until 'valid' is set the next call always reaches OpenGL
+typedef struct {
+    GLuint value;
+    bool valid;
+} render_state_value;
+
+// Shadow copy of the OpenGL state changed through this module, used to filter redundant calls.
+// Everything that changes this state has to go through the functions below (or call ResetRenderState).
+typedef struct {
+    render_state_value blend;
+    render_state_value depth_test;
+    render_state_value cull_face;
+
+    render_state_value blend_func; // Source factor in the high 16 bits, destination in the low ones
+    render_state_value cull_face_mode;
+    render_state_value front_face;
+
+    render_state_value program;
+    render_state_value vertex_array;
+    render_state_value array_buffer;
+    render_state_value element_array_buffer; // Part of the bound vertex array
+    render_state_value uniform_buffer;
+    render_state_value copy_read_buffer;
+    render_state_value copy_write_buffer; // Used to fill buffers without touching the other bindings
+    render_state_value draw_indirect_buffer;
+
+    render_state_value vertex_attribs[RENDER_STATE_VERTEX_ATTRIBS_MAX]; // Part of the bound vertex array
+} render_state;
+
+void ResetRenderState(); // Forgets the shadow copy, e.g. after OpenGL was called directly
+
+void SetRenderStateCapability(GLenum capability, bool enabled); // GL_BLEND, GL_DEPTH_TEST or GL_CULL_FACE
+void SetRenderStateBlendFunc(GLenum source, GLenum destination);
+void SetRenderStateCullFace(GLenum mode);
+void SetRenderStateFrontFace(GLenum mode);
+
+void UseRenderStateProgram(GLuint program);
+void BindRenderStateVertexArray(GLuint vertex_array);
+void BindRenderStateBuffer(GLenum target, GLuint buffer); // Array, element array, uniform, copy read/write and draw indirect buffers
+void SetRenderStateVertexAttribArray(GLuint index, bool enabled);
+
+// Deleting a bound object unbinds it, so the shadow copy has to know about it
+void DeleteRenderStateBuffer(GLuint* buffer);
+void DeleteRenderStateVertexArray(GLuint* vertex_array);
+
+#endif // RENDER_STATE_H
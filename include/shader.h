@@ -1,19 +1,77 @@
 #if !defined (SHADER_H)
 #define SHADER_H
 
+#include <stdbool.h>
+
 #include "glad/glad.h"
+#include "cglm/types.h"
+
+#define SHADER_NAME_LENGTH_MAX 64
+
+// Programs declaring the per-frame uniform block get it attached to this binding point when linked
+#define SHADER_FRAME_BLOCK_NAME "FrameData"
+#define SHADER_FRAME_BINDING 0
+
+// Uniforms every program may declare, resolved once when the program is linked.
+// Camera data isn't part of it, it comes from the per-frame uniform block.
+typedef enum {
+    SHADER_LOC_MATRIX_MODEL, // uMatrixModel
+    SHADER_LOC_COUNT
+} shader_location_index;
+
+typedef struct {
+    GLchar name[SHADER_NAME_LENGTH_MAX]; // Arrays are stored without their "[0]" suffix
+    GLint location;
+    GLenum type;
+    GLint size; // Number of array elements, 1 for plain uniforms
+
+    // Last value uploaded through the setters, an upload is skipped when the new value is the same
+    void* value; GLsizei value_size;
+    bool uploaded;
+} shader_uniform;
+
+typedef struct {
+    GLchar name[SHADER_NAME_LENGTH_MAX];
+    GLint location;
+    GLenum type;
+    GLint size;
+} shader_attribute;
+
+// Linked program with its active uniforms and attributes, reflected once at link time
+typedef struct {
+    GLuint id;
+
+    shader_uniform* uniforms; GLuint uniforms_count;
+    shader_attribute* attributes; GLuint attributes_count;
+
+    shader_uniform* locs[SHADER_LOC_COUNT]; // NULL when the program doesn't use it
+} shader_program;
 
 GLchar* LoadShaderCode(const GLchar* filepath);
 
 GLuint CreateShader(const GLchar* shader_code_filepath, GLuint shader_type);
-GLuint CreateProgram(GLuint vertex_shader, GLuint fragmnet_shader);
+shader_program CreateProgram(GLuint vertex_shader, GLuint fragmnet_shader);
 
 GLuint* GetDefaultShader(GLuint shader_type);
-GLuint* GetDefaultProgram();
+shader_program* GetDefaultProgram();
+shader_program* GetChunkProgram();
 
 void DeleteShader(GLuint shader);
-void DeleteProgram(GLuint program);
+void DeleteProgram(shader_program* program);
+
+// Lookups in the reflected data, no driver round-trip. NULL or -1 when the name isn't active in the program.
+shader_uniform* GetShaderUniform(shader_program* program, const GLchar* uniform_name);
+GLint GetShaderUniformLocation(shader_program* program, const GLchar* uniform_name);
+GLint GetShaderAttributeLocation(shader_program* program, const GLchar* attribute_name);
 
-GLint GetShaderUniformLocation(GLuint program, const GLchar* uniform_name);
+// Typed setters, the program of the uniform must be bound. A NULL uniform is ignored.
+// Return true when the value was actually uploaded.
+bool SetShaderUniformInt(shader_uniform* uniform, GLint value);
+bool SetShaderUniformFloat(shader_uniform* uniform, GLfloat value);
+bool SetShaderUniformVec3(shader_uniform* uniform, vec3 value);
+bool SetShaderUniformVec4(shader_uniform* uniform, vec4 value);
+bool SetShaderUniformMat4(shader_uniform* uniform, mat4 value);
+bool SetShaderUniformFloatArray(shader_uniform* uniform, const GLfloat* values, GLsizei count);
+bool SetShaderUniformVec4Array(shader_uniform* uniform, const vec4* values, GLsizei count);
 
-#endif // SHADER_H
\ No newline at end of file
+#endif // SHADER_H
@@ -0,0 +1,39 @@
+#if !defined (STREAM_BUFFER_H)
+#define STREAM_BUFFER_H
+
+#include <stdbool.h>
+
+#include "glad/glad.h"
+
+#define STREAM_BUFFER_REGIONS 3 // The CPU writes one region while the GPU may still read the two others
+
+// Ring of regions for geometry rewritten every frame. Each region is fenced once the GPU has been
+// given its draws and is only written again after the fence signaled, so the driver never has to
+// stall or reallocate: persistently mapped when GL_ARB_buffer_storage is there, unsynchronized maps otherwise.
+typedef struct {
+    GLuint buffer_id;
+
+    GLsizeiptr region_size; // Always a multiple of 'alignment'
+    GLsizeiptr alignment; // Every push starts at a multiple of it
+    GLuint region; // Region written at the moment
+    GLsizeiptr offset; // Bytes already written in that region
+
+    GLsync fences[STREAM_BUFFER_REGIONS];
+
+    bool persistent;
+    GLubyte* mapping; // Whole buffer, only when persistent
+
+    GLuint waits; // Times the CPU caught up with the GPU and had to wait for a fence
+} stream_buffer;
+
+bool LoadStreamBuffer(stream_buffer* stream, GLsizeiptr region_size, GLsizeiptr alignment);
+void UnloadStreamBuffer(stream_buffer* stream);
+
+// Copies 'data' into the ring and returns its byte offset in the buffer, -1 on failure.
+// A push larger than a region recreates the buffer with larger regions, check 'buffer_id' when it is referenced elsewhere (e.g. by a VAO).
+GLintptr PushStreamBuffer(stream_buffer* stream, const void* data, GLsizeiptr size);
+
+// Fences what was written to the current region and moves to the next one, waiting for the GPU if it's still in use
+void AdvanceStreamBuffer(stream_buffer* stream);
+
+#endif // STREAM_BUFFER_H
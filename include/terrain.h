@@ -0,0 +1,42 @@
+#if !defined (TERRAIN_H)
+#define TERRAIN_H
+
+#include <stdbool.h>
+
+#include "glad/glad.h"
+
+#define TERRAIN_SOIL_DEPTH 4 // Grass and dirt voxels on top of the stone
+
+// Noise kernels, all of them produce bit-identical terrain
+typedef enum {
+    TERRAIN_KERNEL_SCALAR,
+    TERRAIN_KERNEL_SSE41, // 4 samples at a time
+    TERRAIN_KERNEL_AVX2, // 8 samples at a time
+    TERRAIN_KERNEL_COUNT
+} terrain_kernel;
+
+// Deterministic for a given seed: a value noise heightmap, carved by 3D value noise caves.
+// Both are fractal sums of octaves, each one at twice the frequency and half the amplitude of the previous one.
+typedef struct {
+    GLuint seed;
+    terrain_kernel kernel;
+
+    GLfloat height_base; // In voxels
+    GLfloat height_amplitude; // In voxels
+    GLfloat height_scale; // Voxels per noise cell of the first octave
+    GLuint height_octaves;
+
+    GLfloat cave_scale;
+    GLuint cave_octaves; // 0 disables the caves
+    GLfloat cave_threshold; // 0..1, noise above it is carved out
+} terrain_settings;
+
+terrain_settings GetDefaultTerrainSettings(GLuint seed); // Uses the fastest kernel the CPU supports
+
+bool IsTerrainKernelSupported(terrain_kernel kernel);
+const char* GetTerrainKernelName(terrain_kernel kernel);
+
+// A 'chunk_generator' (see chunk.h): fills the CHUNK_VOLUME voxels of the chunk at 'position', thread-safe
+void GenerateTerrain(const void* settings, const int position[3], GLubyte* voxels);
+
+#endif // TERRAIN_H
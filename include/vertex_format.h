@@ -0,0 +1,33 @@
+#if !defined (VERTEX_FORMAT_H)
+#define VERTEX_FORMAT_H
+
+#include "glad/glad.h"
+
+#define VERTEX_FORMAT_ATTRIBUTES_MAX 8
+
+// How the shader sees the components of an attribute
+typedef enum {
+    VERTEX_ATTRIBUTE_FLOAT,      // Converted to float as-is
+    VERTEX_ATTRIBUTE_NORMALIZED, // Integers mapped to [0, 1] or [-1, 1]
+    VERTEX_ATTRIBUTE_INTEGER     // Kept as integers (ivec/uvec inputs)
+} vertex_attribute_mode;
+
+typedef struct {
+    GLuint location; // Matches 'layout (location = N)' in the shader
+    GLint size; // Components, 1 to 4
+    GLenum type;
+    vertex_attribute_mode mode;
+    GLuint offset; // Bytes from the start of the vertex
+} vertex_attribute;
+
+// Layout of an interleaved vertex type, recorded once into every VAO drawing it
+typedef struct {
+    GLsizei stride;
+    GLuint attributes_count;
+    vertex_attribute attributes[VERTEX_FORMAT_ATTRIBUTES_MAX];
+} vertex_format;
+
+// Creates a VAO reading 'format' from 'vertex_buffer', with 'index_buffer' attached. The VAO is left bound.
+GLuint CreateVertexArray(const vertex_format* format, GLuint vertex_buffer, GLuint index_buffer);
+
+#endif // VERTEX_FORMAT_H
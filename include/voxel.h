@@ -3,8 +3,43 @@
 
 #include <stdbool.h>
 
+#include "glad/glad.h"
 #include "cglm/types.h"
 
+#define VOXEL_SIZE 16.0f
+
+// Opposite faces are paired, so 'face ^ 1' is always the opposite face
+typedef enum {
+    VOXEL_FACE_TOP,
+    VOXEL_FACE_DOWN,
+    VOXEL_FACE_FRONT,
+    VOXEL_FACE_BACK,
+    VOXEL_FACE_LEFT,
+    VOXEL_FACE_RIGHT,
+    VOXEL_FACE_COUNT
+} voxel_face;
+
+typedef enum {
+    VOXEL_AIR = 0,
+    VOXEL_STONE,
+    VOXEL_DIRT,
+    VOXEL_GRASS,
+    VOXEL_LAMP,
+    VOXEL_TYPE_COUNT
+} voxel_type;
+
 void RenderVoxel(vec3 position, int size, vec4 tint, bool draw_top, bool draw_down, bool draw_front, bool draw_back, bool draw_left, bool draw_right);
 
-#endif // VOXEL_H
\ No newline at end of file
+// Face helpers shared by RenderVoxel and the chunk mesher.
+// 'position' follows the RenderVoxel convention: the top-left-back corner of the voxel.
+void GetVoxelFaceVertices(vec3 position, GLfloat size, voxel_face face, vec3 vertices[4]);
+void GetVoxelBoxFaceVertices(vec3 position, vec3 size, voxel_face face, vec3 vertices[4]);
+const GLuint* GetVoxelFaceIndices(voxel_face face);
+GLfloat GetVoxelFaceShade(voxel_face face);
+void GetVoxelColor(voxel_type type, vec4 color);
+
+// Lighting: every type but air blocks light, some types give off block light (0 to 15)
+bool IsVoxelOpaque(GLubyte type);
+GLuint GetVoxelEmission(GLubyte type);
+
+#endif // VOXEL_H
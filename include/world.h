@@ -0,0 +1,96 @@
+#if !defined (WORLD_H)
+#define WORLD_H
+
+#include <stdbool.h>
+
+#include "glad/glad.h"
+#include "cglm/types.h"
+
+#include "camera.h"
+#include "chunk.h"
+#include "region.h"
+
+typedef struct {
+    GLuint radius; // Horizontal distance from the camera within which chunks are loaded, in chunks
+    GLuint hysteresis; // Extra distance a chunk may fall behind before it's unloaded, so crossing a border back and forth doesn't reload it
+    int layer_min; // Vertical range of loaded chunks, [layer_min, layer_max)
+    int layer_max;
+
+    // Per-frame budgets, so travelling never does all the work in a single frame
+    GLuint generate_budget; // New chunks started
+    GLuint generate_in_flight_max; // Chunks generating at the same time, keeps the priorities fresh when the camera moves
+    GLuint light_budget; // Chunks relit
+    GLuint mesh_budget; // Meshes started
+    GLuint unload_budget; // Chunks unloaded
+
+    // Distances from the camera, in chunks, past which the chunks are meshed at the next level of detail
+    GLfloat lod_distances[CHUNK_LOD_COUNT - 1];
+    GLfloat lod_hysteresis; // Extra distance before a chunk changes level, so it doesn't flip back and forth on a threshold
+
+    chunk_generator generator;
+    const void* generator_settings; // Must outlive the world
+
+    region_store* regions; // Where edited chunks are saved and loaded from, NULL keeps them in memory only. Must outlive the world
+    GLuint save_interval; // Milliseconds between saves of the edited chunks still loaded, 0 only saves them when they're unloaded
+} world_settings;
+
+typedef enum {
+    WORLD_ENTRY_EMPTY,
+    WORLD_ENTRY_USED,
+    WORLD_ENTRY_DELETED
+} world_entry_state;
+
+typedef struct {
+    world_entry_state state;
+    int position[3];
+    chunk* chunk;
+} world_entry;
+
+typedef struct {
+    chunk* chunk; // NULL for a position still to be loaded
+    int position[3];
+    GLfloat priority; // Lower goes first
+} world_candidate;
+
+typedef struct {
+    GLuint loaded;
+    GLuint generating;
+    GLuint lighting;
+    GLuint meshing;
+
+    // Work started by the last UpdateWorld
+    GLuint generated;
+    GLuint lit;
+    GLuint meshed;
+    GLuint unloaded;
+    GLuint saved; // Queued for the region writer
+} world_stats;
+
+// Streams chunks in and out around the camera, so the world has no edge.
+// Chunks are found through an open addressing hash table (linear probing) keyed on their position.
+typedef struct {
+    world_settings settings;
+
+    world_entry* entries; GLuint entries_count; GLuint entries_deleted; GLuint entries_capacity; // Capacity is a power of two
+
+    world_candidate* candidates; GLuint candidates_count; GLuint candidates_count_max;
+
+    int center[3]; // Chunk the camera was in during the last update
+    bool complete; // Every position around the center is loaded, no need to look for more until the camera moves
+    GLuint save_time; // SDL_GetTicks of the last save
+
+    world_stats stats;
+} world;
+
+world_settings GetDefaultWorldSettings(chunk_generator generator, const void* generator_settings);
+
+bool LoadWorld(world* world, world_settings settings);
+void UnloadWorld(world* world);
+
+// Loads, lights, meshes and unloads chunks around the camera within the budgets, nearest and most in view first
+void UpdateWorld(world* world, camera* camera);
+void RenderWorld(world* world);
+
+chunk* GetWorldChunk(world* world, int x, int y, int z);
+
+#endif // WORLD_H
@@ -0,0 +1,55 @@
+#version 330 core
+
+// Packed chunk vertex, see 'vert_packed' in include/chunk.h
+layout (location = 0) in uvec2 aPacked;
+
+out vec4 vColor;
+out vec2 vTexCoord;
+out float vTexId;
+
+// Per-frame data shared by every program, see 'frame_uniforms' in include/core.h
+layout (std140) uniform FrameData {
+    mat4 uMatrixView;
+    mat4 uMatrixProjection;
+    mat4 uMatrixViewProjection;
+    vec4 uCameraPosition;
+    vec2 uViewportSize;
+    float uTime;
+};
+
+uniform samplerBuffer uChunkOffsets; // World offset of every chunk, indexed by the slot in its vertices
+uniform float uVoxelSize;
+
+uniform vec4 uVoxelColors[16];
+uniform float uFaceShade[6];
+
+void main() {
+    vec3 position = vec3(
+        float((aPacked.x >> 0u) & 63u),
+        float((aPacked.x >> 6u) & 63u),
+        float((aPacked.x >> 12u) & 63u)
+    );
+
+    uint face = (aPacked.x >> 18u) & 7u;
+    uint ambient_occlusion = (aPacked.x >> 21u) & 3u;
+
+    uint type = (aPacked.y >> 0u) & 255u;
+    uint sunlight = (aPacked.y >> 8u) & 15u;
+    uint blocklight = (aPacked.y >> 12u) & 15u;
+    uint slot = (aPacked.y >> 16u) & 65535u;
+
+    vec3 chunk_offset = texelFetch(uChunkOffsets, int(slot)).xyz;
+
+    gl_Position = uMatrixViewProjection * vec4(chunk_offset + position * uVoxelSize, 1.0f);
+
+    // A little ambient light, so the places neither the sun nor a light source reaches aren't pitch black
+    float light = mix(0.08f, 1.0f, max(float(sunlight), float(blocklight)) / 15.0f);
+    float occlusion = 1.0f - float(ambient_occlusion) * 0.2f;
+    float shade = uFaceShade[face] * light * occlusion;
+
+    vColor = vec4(uVoxelColors[type & 15u].rgb * shade, uVoxelColors[type & 15u].a);
+
+    // World-aligned texture coordinates, repeating once per voxel
+    vTexCoord = face < 2u ? position.xz : (face < 4u ? position.xy : position.zy);
+    vTexId = float(type);
+}
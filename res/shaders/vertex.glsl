@@ -9,11 +9,18 @@ out vec4 vColor;
 out vec2 vTexCoord;
 out float vTexId;
 
-uniform mat4 uMatrixProjection;
-uniform mat4 uMatrixView;
+// Per-frame data shared by every program, see 'frame_uniforms' in include/core.h
+layout (std140) uniform FrameData {
+    mat4 uMatrixView;
+    mat4 uMatrixProjection;
+    mat4 uMatrixViewProjection;
+    vec4 uCameraPosition;
+    vec2 uViewportSize;
+    float uTime;
+};
 
 void main() {
-    gl_Position = uMatrixProjection * uMatrixView * vec4(aPosition, 1.0f);
+    gl_Position = uMatrixViewProjection * vec4(aPosition, 1.0f);
 
     vColor = aColor;
     vTexCoord = aTexCoord;
@@ -4,7 +4,6 @@
 #include "cglm/cglm.h"
 
 #include "input.h"
-#include "shader.h"
 #include "core.h"
 
 extern core_data CORE;
@@ -51,29 +50,14 @@ void CameraMatrix(camera* camera) {
         }
     }
     
-    glUniformMatrix4fv(
-        GetShaderUniformLocation(
-            *GetDefaultProgram(), 
-            "uMatrixProjection"
-        ), 
-        1, 
-        GL_FALSE, 
-        &camera->projection[0][0]
-    );
-
     vec3 camera_center;
     glm_vec3_add(camera->position, camera->direction, camera_center);  
 
     glm_lookat(camera->position, camera_center, (vec3) { 0.0f, 1.0f, 0.0f }, camera->view);
-    glUniformMatrix4fv(
-        GetShaderUniformLocation(
-            *GetDefaultProgram(), 
-            "uMatrixView"
-        ), 
-        1, 
-        GL_FALSE, 
-        &camera->view[0][0]
-    );
+
+    // Every program declaring the frame block sees the new matrices after this single upload
+    UpdateFrameUniforms(camera->projection, camera->view, camera->position);
+    glm_frustum_planes(CORE.frame.data.view_projection, camera->frustum);
 }
 
 void CameraMovement(camera* camera, bool enable) {
@@ -0,0 +1,1020 @@
+#include "chunk.h"
+
+#include <stdio.h>
+
+#include "SDL2/SDL.h"
+#include "glad/glad.h"
+#include "cglm/cglm.h"
+
+#include "chunk_arena.h"
+#include "core.h"
+#include "job.h"
+#include "light.h"
+#include "shader.h"
+#include "voxel.h"
+
+extern core_data CORE;
+
+struct chunk_mesh_job {
+    chunk* chunk; // NULL once the chunk was unloaded while the job was running
+    chunk_mesh_mode mode;
+    GLuint lod;
+    GLuint seams;
+    chunk_mesh mesh;
+    GLubyte voxels[CHUNK_PADDED_VOLUME]; // Snapshot taken when the job was scheduled
+    GLubyte light[CHUNK_PADDED_VOLUME];
+};
+
+struct chunk_generate_job {
+    chunk* chunk; // NULL once the chunk was unloaded while the job was running
+    SDL_atomic_t cancelled; // Set with 'chunk', so a worker that hasn't started yet skips the work
+    chunk_generator generator;
+    const void* settings;
+    int position[3];
+    GLubyte voxels[CHUNK_VOLUME];
+};
+
+// Offset to the adjacent voxel for every voxel_face
+static const int chunk_face_offsets[VOXEL_FACE_COUNT][3] = {
+    {  0,  1,  0 }, // Face: UP
+    {  0, -1,  0 }, // Face: DOWN
+    {  0,  0,  1 }, // Face: FRONT
+    {  0,  0, -1 }, // Face: BACK
+    { -1,  0,  0 }, // Face: LEFT
+    {  1,  0,  0 }, // Face: RIGHT
+};
+
+// Normal, U and V axis (0 = X, 1 = Y, 2 = Z) for every voxel_face,
+// where U and V follow the texture coordinates of GetVoxelFaceVertices
+static const int chunk_face_axes[VOXEL_FACE_COUNT][3] = {
+    { 1, 0, 2 }, // Face: UP
+    { 1, 0, 2 }, // Face: DOWN
+    { 2, 0, 1 }, // Face: FRONT
+    { 2, 0, 1 }, // Face: BACK
+    { 0, 2, 1 }, // Face: LEFT
+    { 0, 2, 1 }, // Face: RIGHT
+};
+
+static bool ReserveChunkMesh(chunk_mesh* mesh, GLuint vertices_count, GLuint indices_count) {
+    if(mesh->vertices_count + vertices_count > mesh->vertices_count_max) {
+        GLuint count_max = mesh->vertices_count_max ? mesh->vertices_count_max : 1024;
+        while(count_max < mesh->vertices_count + vertices_count) {
+            count_max *= 2;
+        }
+
+        vert_packed* vertices = (vert_packed*) SDL_realloc(mesh->vertices, count_max * sizeof(vert_packed));
+        if(!vertices) {
+            fprintf(stderr, "[ERR] CHUNK: Could not grow the mesh vertices | Count: %u\n", count_max);
+
+            return false;
+        }
+
+        mesh->vertices = vertices;
+        mesh->vertices_count_max = count_max;
+    }
+
+    if(mesh->indices_count + indices_count > mesh->indices_count_max) {
+        GLuint count_max = mesh->indices_count_max ? mesh->indices_count_max : 1536;
+        while(count_max < mesh->indices_count + indices_count) {
+            count_max *= 2;
+        }
+
+        GLuint* indices = (GLuint*) SDL_realloc(mesh->indices, count_max * sizeof(GLuint));
+        if(!indices) {
+            fprintf(stderr, "[ERR] CHUNK: Could not grow the mesh indices | Count: %u\n", count_max);
+
+            return false;
+        }
+
+        mesh->indices = indices;
+        mesh->indices_count_max = count_max;
+    }
+
+    return true;
+}
+
+static vert_packed PackChunkVertex(GLuint x, GLuint y, GLuint z, voxel_face face, GLuint ambient_occlusion, GLubyte type, GLuint sunlight, GLuint blocklight) {
+    return (vert_packed) {
+        .position_face =
+            (x << VERT_PACKED_X_SHIFT) |
+            (y << VERT_PACKED_Y_SHIFT) |
+            (z << VERT_PACKED_Z_SHIFT) |
+            ((GLuint) face << VERT_PACKED_FACE_SHIFT) |
+            (ambient_occlusion << VERT_PACKED_AO_SHIFT),
+
+        .type_light =
+            ((GLuint) type << VERT_PACKED_TYPE_SHIFT) |
+            (sunlight << VERT_PACKED_SUNLIGHT_SHIFT) |
+            (blocklight << VERT_PACKED_BLOCKLIGHT_SHIFT)
+    };
+}
+
+// Triangles of a quad split along its other diagonal (corners 0 and 3), for both windings of voxel_face_indices
+static const GLuint chunk_quad_indices_flipped[2][6] = {
+    { 0, 1, 3, 0, 3, 2 },
+    { 3, 1, 0, 2, 3, 0 },
+};
+
+// Quad in voxel units: 'origin' is the minimum corner and 'extent' the size on each axis.
+// 'occlusion' holds the ambient occlusion of the 4 corners (see GetChunkFaceOcclusion), 'light' the light byte in front of the face.
+static void PushChunkMeshQuad(chunk_mesh* mesh, int origin[3], int extent[3], voxel_face face, GLubyte type, GLuint occlusion, GLubyte light) {
+    if(!ReserveChunkMesh(mesh, 4, 6)) {
+        return;
+    }
+
+    // Chunk-local voxel units; GetVoxelBoxFaceVertices expects the top-left-back corner, so the box spans [y, y + extent]
+    vec3 position = { origin[0], origin[1] + extent[1], origin[2] };
+    vec3 size = { extent[0], extent[1], extent[2] };
+
+    vec3 face_vertices[4];
+    GetVoxelBoxFaceVertices(position, size, face, face_vertices);
+
+    const int axis_u = chunk_face_axes[face][1];
+    const int axis_v = chunk_face_axes[face][2];
+
+    GLuint indicy_base = mesh->vertices_count;
+    GLuint vertex_occlusion[4];
+
+    // Light sources show their own light
+    const GLuint sunlight = LIGHT_SUN(light);
+    const GLuint blocklight = SDL_max(LIGHT_BLOCK(light), GetVoxelEmission(type));
+
+    for(int vert_index = 0; vert_index < 4; vert_index++) {
+        GLuint corner = (face_vertices[vert_index][axis_u] > origin[axis_u]) | ((face_vertices[vert_index][axis_v] > origin[axis_v]) << 1);
+        vertex_occlusion[vert_index] = (occlusion >> (corner * 2)) & 3;
+
+        mesh->vertices[mesh->vertices_count++] = PackChunkVertex(
+            (GLuint) face_vertices[vert_index][0],
+            (GLuint) face_vertices[vert_index][1],
+            (GLuint) face_vertices[vert_index][2],
+            face, vertex_occlusion[vert_index], type, sunlight, blocklight
+        );
+    }
+
+    // The occlusion is interpolated across each triangle, so the diagonal through the darker pair of corners
+    // keeps the gradient symmetric instead of smearing it into one of the triangles
+    const GLuint* face_indices = GetVoxelFaceIndices(face);
+    if(vertex_occlusion[0] + vertex_occlusion[3] > vertex_occlusion[1] + vertex_occlusion[2]) {
+        face_indices = chunk_quad_indices_flipped[face_indices[0] == 0 ? 0 : 1];
+    }
+
+    for(int indices = 0; indices < 6; indices++) {
+        mesh->indices[mesh->indices_count++] = indicy_base + face_indices[indices];
+    }
+}
+
+// Index into a padded grid of 'size' cells per side, the layout of CHUNK_PADDED_INDEX for any size
+static int GetChunkCellIndex(int size, int x, int y, int z) {
+    return (x + 1) + (z + 1) * (size + 2) + (y + 1) * (size + 2) * (size + 2);
+}
+
+// Offsets between adjacent cells along the normal, U and V axis of the face
+static void GetChunkFaceOffsets(int size, voxel_face face, int offsets[3]) {
+    for(int axis = 0; axis < 3; axis++) {
+        int position[3] = { 0, 0, 0 };
+        position[chunk_face_axes[face][axis]] = axis == 0 ? chunk_face_offsets[face][chunk_face_axes[face][0]] : 1;
+
+        offsets[axis] = GetChunkCellIndex(size, position[0], position[1], position[2]) - GetChunkCellIndex(size, 0, 0, 0);
+    }
+}
+
+// Ambient occlusion of the 4 corners of the face of the cell at 'index', from the 2 side and the diagonal cells
+// in front of each corner. 2 bits per corner, in (-U -V, +U -V, -U +V, +U +V) order: 0 is open, 3 is fully occluded.
+static GLuint GetChunkFaceOcclusion(const GLubyte* cells, int index, const int offsets[3]) {
+    const int front = index + offsets[0];
+    GLuint occlusion = 0;
+
+    for(int corner = 0; corner < 4; corner++) {
+        const int offset_u = (corner & 1) ? offsets[1] : -offsets[1];
+        const int offset_v = (corner & 2) ? offsets[2] : -offsets[2];
+
+        GLuint side_u = cells[front + offset_u] != VOXEL_AIR;
+        GLuint side_v = cells[front + offset_v] != VOXEL_AIR;
+        GLuint diagonal = cells[front + offset_u + offset_v] != VOXEL_AIR;
+
+        // Two sides already hide the corner completely
+        GLuint value = (side_u && side_v) ? 3 : side_u + side_v + diagonal;
+
+        occlusion |= value << (corner * 2);
+    }
+
+    return occlusion;
+}
+
+// Light byte lighting the face of the cell at 'index', from the cell in front of it ('light' matches 'cells', NULL is the open sky)
+static GLubyte GetChunkFaceLight(const GLubyte* light, int index, const int offsets[3]) {
+    return light ? light[index + offsets[0]] : LIGHT_SKY;
+}
+
+// 'cells' is a padded grid of 'size' cells per side, each 'scale' voxels wide
+static void BuildChunkMeshNaive(const GLubyte* cells, const GLubyte* light, int size, int scale, chunk_mesh* mesh) {
+    int face_offsets[VOXEL_FACE_COUNT][3];
+    for(int face = 0; face < VOXEL_FACE_COUNT; face++) {
+        GetChunkFaceOffsets(size, face, face_offsets[face]);
+    }
+
+    for(int y = 0; y < size; y++) {
+        for(int z = 0; z < size; z++) {
+            for(int x = 0; x < size; x++) {
+                int index = GetChunkCellIndex(size, x, y, z);
+
+                GLubyte type = cells[index];
+                if(type == VOXEL_AIR) {
+                    continue;
+                }
+
+                int origin[3] = { x * scale, y * scale, z * scale };
+                int extent[3] = { scale, scale, scale };
+
+                for(int face = 0; face < VOXEL_FACE_COUNT; face++) {
+                    if(cells[index + face_offsets[face][0]] != VOXEL_AIR) {
+                        continue;
+                    }
+
+                    PushChunkMeshQuad(mesh, origin, extent, face, type, GetChunkFaceOcclusion(cells, index, face_offsets[face]), GetChunkFaceLight(light, index, face_offsets[face]));
+                }
+            }
+        }
+    }
+}
+
+// Whether every cell inside the padding holds the same type, stored in 'type'
+static bool IsChunkCellsUniform(const GLubyte* cells, int size, GLubyte* type) {
+    GLubyte row[CHUNK_SIZE];
+
+    *type = cells[GetChunkCellIndex(size, 0, 0, 0)];
+    SDL_memset(row, *type, size);
+
+    for(int y = 0; y < size; y++) {
+        for(int z = 0; z < size; z++) {
+            if(SDL_memcmp(&cells[GetChunkCellIndex(size, 0, y, z)], row, size) != 0) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static void BuildChunkMeshGreedy(const GLubyte* cells, const GLubyte* light, int size, int scale, chunk_mesh* mesh) {
+    // Voxel type in the low byte, then the corner occlusion and the light, so only faces that are shaded alike merge
+    GLuint mask[CHUNK_SIZE * CHUNK_SIZE];
+
+    // Uniform chunks are common (open sky, solid ground): air has no faces at all, solid ones only on the borders
+    GLubyte uniform_type;
+    const bool uniform = IsChunkCellsUniform(cells, size, &uniform_type);
+
+    if(uniform && uniform_type == VOXEL_AIR) {
+        return;
+    }
+
+    for(int face = 0; face < VOXEL_FACE_COUNT; face++) {
+        const int axis_n = chunk_face_axes[face][0];
+        const int axis_u = chunk_face_axes[face][1];
+        const int axis_v = chunk_face_axes[face][2];
+
+        int offsets[3];
+        GetChunkFaceOffsets(size, face, offsets);
+
+        int slice_first = 0;
+        int slice_last = size - 1;
+
+        if(uniform) {
+            slice_first = chunk_face_offsets[face][axis_n] > 0 ? size - 1 : 0;
+            slice_last = slice_first;
+        }
+
+        for(int slice = slice_first; slice <= slice_last; slice++) {
+            // 1. Collect the visible faces of this slice into a 2D mask of voxel types, occlusion and light
+
+            int position[3];
+            position[axis_n] = slice;
+            position[axis_u] = 0;
+            position[axis_v] = 0;
+
+            // Walks the slice by the cell offsets along U and V instead of computing every index
+            const int slice_index = GetChunkCellIndex(size, position[0], position[1], position[2]);
+            bool visible = false;
+
+            for(int v = 0; v < size; v++) {
+                int index = slice_index + v * offsets[2];
+
+                for(int u = 0; u < size; u++, index += offsets[1]) {
+                    GLubyte type = cells[index];
+                    if(type == VOXEL_AIR || cells[index + offsets[0]] != VOXEL_AIR) {
+                        mask[u + v * size] = 0;
+
+                        continue;
+                    }
+
+                    mask[u + v * size] = type | (GetChunkFaceOcclusion(cells, index, offsets) << 8) | ((GLuint) GetChunkFaceLight(light, index, offsets) << 16);
+                    visible = true;
+                }
+            }
+
+            if(!visible) {
+                continue;
+            }
+
+            // 2. Merge equal neighbouring cells: grow along U first, then along V while the whole row matches
+
+            for(int v = 0; v < size; v++) {
+                for(int u = 0; u < size; ) {
+                    GLuint key = mask[u + v * size];
+                    if(key == 0) {
+                        u++;
+
+                        continue;
+                    }
+
+                    int width = 1;
+                    while(u + width < size && mask[u + width + v * size] == key) {
+                        width++;
+                    }
+
+                    int height = 1;
+                    for(; v + height < size; height++) {
+                        bool row_matches = true;
+                        for(int k = 0; k < width; k++) {
+                            if(mask[u + k + (v + height) * size] != key) {
+                                row_matches = false;
+
+                                break;
+                            }
+                        }
+
+                        if(!row_matches) {
+                            break;
+                        }
+                    }
+
+                    int origin[3];
+                    origin[axis_n] = slice * scale;
+                    origin[axis_u] = u * scale;
+                    origin[axis_v] = v * scale;
+
+                    int extent[3];
+                    extent[axis_n] = scale;
+                    extent[axis_u] = width * scale;
+                    extent[axis_v] = height * scale;
+
+                    PushChunkMeshQuad(mesh, origin, extent, face, key & 0xFF, (key >> 8) & 0xFF, key >> 16);
+
+                    for(int row = 0; row < height; row++) {
+                        SDL_memset(&mask[u + (v + row) * size], 0, width * sizeof(GLuint));
+                    }
+
+                    u += width;
+                }
+            }
+        }
+    }
+}
+
+// Type of the 'scale' wide cell at the voxel 'x, y, z' of the padded voxels: air unless at least half of it is solid,
+// otherwise the most common type of its highest layer holding solid voxels, so surfaces keep their look
+static GLubyte GetChunkCellType(const GLubyte* voxels, int x, int y, int z, int scale) {
+    GLubyte layer[CHUNK_LOD_SCALE_MAX * CHUNK_LOD_SCALE_MAX];
+    GLuint layer_count = 0;
+    int layer_y = -1;
+    GLuint solid = 0;
+
+    for(int cell_y = scale - 1; cell_y >= 0; cell_y--) {
+        for(int cell_z = 0; cell_z < scale; cell_z++) {
+            for(int cell_x = 0; cell_x < scale; cell_x++) {
+                GLubyte type = voxels[CHUNK_PADDED_INDEX(x + cell_x, y + cell_y, z + cell_z)];
+                if(type == VOXEL_AIR) {
+                    continue;
+                }
+
+                if(layer_y < 0) {
+                    layer_y = cell_y;
+                }
+
+                if(cell_y == layer_y) {
+                    layer[layer_count++] = type;
+                }
+
+                solid++;
+            }
+        }
+    }
+
+    if(layer_count == 0 || solid * 2 < (GLuint) (scale * scale * scale)) {
+        return VOXEL_AIR;
+    }
+
+    GLubyte result = layer[0];
+    GLuint result_count = 0;
+
+    for(GLuint index = 0; index < layer_count; index++) {
+        GLuint count = 0;
+        for(GLuint other = index; other < layer_count; other++) {
+            count += layer[other] == layer[index];
+        }
+
+        if(count > result_count) {
+            result = layer[index];
+            result_count = count;
+        }
+    }
+
+    return result;
+}
+
+// Downsamples the padded voxels into a padded grid of cells 'scale' voxels wide. The padding is air on the seams
+// (and everywhere for coarse cells), so the faces on those borders are always built.
+static void BuildChunkCells(const GLubyte* voxels, int scale, GLuint seams, GLubyte* cells) {
+    if(scale == 1) {
+        SDL_memcpy(cells, voxels, CHUNK_PADDED_VOLUME);
+
+        for(int face = 0; face < VOXEL_FACE_COUNT; face++) {
+            if(!(seams & (1u << face))) {
+                continue;
+            }
+
+            const int axis_n = chunk_face_axes[face][0];
+            const int axis_u = chunk_face_axes[face][1];
+            const int axis_v = chunk_face_axes[face][2];
+            const int slice = chunk_face_offsets[face][axis_n] > 0 ? CHUNK_SIZE : -1;
+
+            // Edges included, the ambient occlusion of the border faces reads them
+            for(int v = -1; v <= CHUNK_SIZE; v++) {
+                for(int u = -1; u <= CHUNK_SIZE; u++) {
+                    int position[3];
+                    position[axis_n] = slice;
+                    position[axis_u] = u;
+                    position[axis_v] = v;
+
+                    cells[CHUNK_PADDED_INDEX(position[0], position[1], position[2])] = VOXEL_AIR;
+                }
+            }
+        }
+
+        return;
+    }
+
+    // A coarse cell can't be told from a single voxel of padding
+    const int size = CHUNK_SIZE / scale;
+
+    SDL_memset(cells, VOXEL_AIR, (size + 2) * (size + 2) * (size + 2));
+
+    for(int y = 0; y < size; y++) {
+        for(int z = 0; z < size; z++) {
+            for(int x = 0; x < size; x++) {
+                cells[GetChunkCellIndex(size, x, y, z)] = GetChunkCellType(voxels, x * scale, y * scale, z * scale, scale);
+            }
+        }
+    }
+}
+
+// Light of the coarse cells: the brightest voxel of each cell, so a lit surface stays lit. The padding cells
+// only have the single voxel layer of the snapshot to read from.
+static void BuildChunkLightCells(const GLubyte* light, int scale, GLubyte* cells) {
+    const int size = CHUNK_SIZE / scale;
+
+    for(int y = -1; y <= size; y++) {
+        for(int z = -1; z <= size; z++) {
+            for(int x = -1; x <= size; x++) {
+                const int min[3] = { SDL_max(x * scale, -1), SDL_max(y * scale, -1), SDL_max(z * scale, -1) };
+                const int max[3] = { SDL_min((x + 1) * scale, CHUNK_SIZE + 1), SDL_min((y + 1) * scale, CHUNK_SIZE + 1), SDL_min((z + 1) * scale, CHUNK_SIZE + 1) };
+
+                GLuint sunlight = 0;
+                GLuint blocklight = 0;
+
+                for(int cell_y = min[1]; cell_y < max[1]; cell_y++) {
+                    for(int cell_z = min[2]; cell_z < max[2]; cell_z++) {
+                        for(int cell_x = min[0]; cell_x < max[0]; cell_x++) {
+                            GLubyte value = light[CHUNK_PADDED_INDEX(cell_x, cell_y, cell_z)];
+
+                            sunlight = SDL_max(sunlight, (GLuint) LIGHT_SUN(value));
+                            blocklight = SDL_max(blocklight, (GLuint) LIGHT_BLOCK(value));
+                        }
+                    }
+                }
+
+                cells[GetChunkCellIndex(size, x, y, z)] = LIGHT_PACK(sunlight, blocklight);
+            }
+        }
+    }
+}
+
+// Runs on a worker thread: only touches the job's own snapshot and mesh
+static void ChunkMeshJob(void* data) {
+    chunk_mesh_job* job = (chunk_mesh_job*) data;
+
+    BuildChunkLodMeshFromVoxels(job->voxels, job->light, job->mode, job->lod, job->seams, &job->mesh);
+}
+
+static void ChunkGenerateJob(void* data) {
+    chunk_generate_job* job = (chunk_generate_job*) data;
+
+    if(SDL_AtomicGet(&job->cancelled)) {
+        return;
+    }
+
+    job->generator(job->settings, job->position, job->voxels);
+}
+
+static void ChunkGenerateJobComplete(void* data) {
+    chunk_generate_job* job = (chunk_generate_job*) data;
+
+    if(job->chunk) {
+        job->chunk->generate_job = NULL;
+        SetChunkVoxels(job->chunk, job->voxels);
+        job->chunk->modified = false; // Generated voxels can always be generated again
+    }
+
+    SDL_free(job);
+}
+
+// Runs on the main thread, which owns the OpenGL context
+static void ChunkMeshJobComplete(void* data) {
+    chunk_mesh_job* job = (chunk_mesh_job*) data;
+
+    if(job->chunk) {
+        chunk* chunk = job->chunk;
+
+        SDL_free(chunk->mesh.vertices);
+        SDL_free(chunk->mesh.indices);
+        chunk->mesh = job->mesh;
+        chunk->mesh_job = NULL;
+
+        // If the chunk was edited meanwhile it's dirty again and gets re-scheduled
+        UploadChunkMesh(chunk);
+    } else {
+        SDL_free(job->mesh.vertices);
+        SDL_free(job->mesh.indices);
+    }
+
+    SDL_free(job);
+}
+
+chunk* LoadChunk(ivec3 position) {
+    chunk* result = (chunk*) SDL_calloc(1, sizeof(chunk));
+    if(!result) {
+        fprintf(stderr, "[ERR] CHUNK: Could not allocate a chunk\n");
+
+        return NULL;
+    }
+
+    // Starts out as a uniform chunk of air, which needs no voxel memory at all
+    LoadChunkStorage(&result->voxels, CHUNK_VOLUME, VOXEL_AIR);
+    LoadChunkStorage(&result->light, CHUNK_VOLUME, 0);
+
+    result->position[0] = position[0];
+    result->position[1] = position[1];
+    result->position[2] = position[2];
+
+    result->mesh_mode = CHUNK_MESH_GREEDY;
+    result->dirty = true;
+    result->light_reset = true;
+
+    return result;
+}
+
+void UnloadChunk(chunk* chunk) {
+    if(!chunk) {
+        return;
+    }
+
+    // A worker may still be meshing or generating the chunk, its result will be thrown away
+    if(chunk->mesh_job) {
+        chunk->mesh_job->chunk = NULL;
+    }
+
+    if(chunk->generate_job) {
+        chunk->generate_job->chunk = NULL;
+        SDL_AtomicSet(&chunk->generate_job->cancelled, 1);
+    }
+
+    // Detach from the neighbours so they don't keep a dangling pointer
+    for(int face = 0; face < VOXEL_FACE_COUNT; face++) {
+        if(chunk->neighbours[face]) {
+            chunk->neighbours[face]->neighbours[face ^ 1] = NULL;
+            chunk->neighbours[face]->dirty = true;
+        }
+    }
+
+    ClearChunkLight(chunk);
+    ReleaseChunkArena(chunk);
+
+    SDL_free(chunk->mesh.vertices);
+    SDL_free(chunk->mesh.indices);
+    UnloadChunkStorage(&chunk->voxels);
+    UnloadChunkStorage(&chunk->light);
+    SDL_free(chunk);
+}
+
+// Chunk holding the voxel at 'x, y, z' (relative to 'chunk', at most one chunk away on every axis), with the coordinates made local to it
+static chunk* GetChunkAt(chunk* chunk, int* x, int* y, int* z) {
+    if(*x < 0) {
+        chunk = chunk->neighbours[VOXEL_FACE_LEFT]; *x += CHUNK_SIZE;
+    } else if(*x >= CHUNK_SIZE) {
+        chunk = chunk->neighbours[VOXEL_FACE_RIGHT]; *x -= CHUNK_SIZE;
+    }
+
+    if(chunk && *y < 0) {
+        chunk = chunk->neighbours[VOXEL_FACE_DOWN]; *y += CHUNK_SIZE;
+    } else if(chunk && *y >= CHUNK_SIZE) {
+        chunk = chunk->neighbours[VOXEL_FACE_TOP]; *y -= CHUNK_SIZE;
+    }
+
+    if(chunk && *z < 0) {
+        chunk = chunk->neighbours[VOXEL_FACE_BACK]; *z += CHUNK_SIZE;
+    } else if(chunk && *z >= CHUNK_SIZE) {
+        chunk = chunk->neighbours[VOXEL_FACE_FRONT]; *z -= CHUNK_SIZE;
+    }
+
+    return chunk;
+}
+
+GLubyte GetChunkVoxel(chunk* chunk, int x, int y, int z) {
+    chunk = GetChunkAt(chunk, &x, &y, &z);
+    if(!chunk) {
+        return VOXEL_AIR;
+    }
+
+    return GetChunkStorageVoxel(&chunk->voxels, CHUNK_INDEX(x, y, z));
+}
+
+GLubyte GetChunkLight(chunk* chunk, int x, int y, int z) {
+    chunk = GetChunkAt(chunk, &x, &y, &z);
+    if(!chunk) {
+        return 0;
+    }
+
+    return GetChunkStorageVoxel(&chunk->light, CHUNK_INDEX(x, y, z));
+}
+
+void SetChunkVoxel(chunk* chunk, int x, int y, int z, GLubyte type) {
+    if(!SetChunkStorageVoxel(&chunk->voxels, CHUNK_INDEX(x, y, z), type)) {
+        return;
+    }
+
+    chunk->dirty = true;
+    chunk->modified = true;
+
+    QueueChunkLightEvent(chunk, (light_event) { .index = CHUNK_INDEX(x, y, z), .kind = LIGHT_EVENT_VOXEL });
+
+    // Voxels on the border are also visible to the adjacent chunk's mesher
+    const bool border[VOXEL_FACE_COUNT] = {
+        y == CHUNK_SIZE - 1, y == 0,
+        z == CHUNK_SIZE - 1, z == 0,
+        x == 0, x == CHUNK_SIZE - 1
+    };
+
+    for(int face = 0; face < VOXEL_FACE_COUNT; face++) {
+        if(border[face] && chunk->neighbours[face]) {
+            chunk->neighbours[face]->dirty = true;
+        }
+    }
+}
+
+void FillChunk(chunk* chunk, GLubyte type) {
+    FillChunkStorage(&chunk->voxels, type);
+    chunk->dirty = true;
+    chunk->modified = true;
+
+    QueueChunkLightReset(chunk);
+
+    for(int face = 0; face < VOXEL_FACE_COUNT; face++) {
+        if(chunk->neighbours[face]) {
+            chunk->neighbours[face]->dirty = true;
+        }
+    }
+}
+
+void SetChunkVoxels(chunk* chunk, const GLubyte* voxels) {
+    if(!EncodeChunkStorage(&chunk->voxels, voxels)) {
+        return;
+    }
+
+    chunk->dirty = true;
+    chunk->modified = true;
+
+    QueueChunkLightReset(chunk);
+
+    for(int face = 0; face < VOXEL_FACE_COUNT; face++) {
+        if(chunk->neighbours[face]) {
+            chunk->neighbours[face]->dirty = true;
+        }
+    }
+}
+
+void SetChunkLod(chunk* chunk, GLuint lod) {
+    if(chunk->lod == lod) {
+        return;
+    }
+
+    chunk->lod = lod;
+    chunk->dirty = true;
+
+    // The seams on the shared borders change too
+    for(int face = 0; face < VOXEL_FACE_COUNT; face++) {
+        if(chunk->neighbours[face]) {
+            chunk->neighbours[face]->dirty = true;
+        }
+    }
+}
+
+void ShrinkChunk(chunk* chunk) {
+    ShrinkChunkStorage(&chunk->voxels);
+}
+
+// The voxels or the light of the chunk, with a one voxel border read from the neighbours
+static void CopyChunkPadded(chunk* chunk, bool light, GLubyte* padded) {
+    GLubyte (*get)(struct chunk*, int, int, int) = light ? GetChunkLight : GetChunkVoxel;
+
+    for(int y = -1; y <= CHUNK_SIZE; y++) {
+        for(int z = -1; z <= CHUNK_SIZE; z++) {
+            GLubyte* row = &padded[CHUNK_PADDED_INDEX(0, y, z)];
+
+            // Every row is contiguous in the chunk holding it, this one or a neighbour for the border rows
+            int row_x = 0;
+            int row_y = y;
+            int row_z = z;
+
+            struct chunk* owner = GetChunkAt(chunk, &row_x, &row_y, &row_z);
+            if(owner) {
+                DecodeChunkStorage(light ? &owner->light : &owner->voxels, CHUNK_INDEX(0, row_y, row_z), CHUNK_SIZE, row);
+            } else {
+                SDL_memset(row, light ? 0 : VOXEL_AIR, CHUNK_SIZE);
+            }
+
+            row[-1] = get(chunk, -1, y, z);
+            row[CHUNK_SIZE] = get(chunk, CHUNK_SIZE, y, z);
+        }
+    }
+}
+
+void CopyChunkVoxels(chunk* chunk, GLubyte* voxels) {
+    CopyChunkPadded(chunk, false, voxels);
+}
+
+void CopyChunkLight(chunk* chunk, GLubyte* light) {
+    CopyChunkPadded(chunk, true, light);
+}
+
+// Light snapshot for the mesher: nothing is loaded above the highest chunks, the faces looking up there see the sky
+static void CopyChunkMeshLight(chunk* chunk, GLubyte* light) {
+    CopyChunkLight(chunk, light);
+
+    if(chunk->neighbours[VOXEL_FACE_TOP]) {
+        return;
+    }
+
+    for(int z = -1; z <= CHUNK_SIZE; z++) {
+        SDL_memset(&light[CHUNK_PADDED_INDEX(-1, CHUNK_SIZE, z)], LIGHT_SKY, CHUNK_PADDED_SIZE);
+    }
+}
+
+void BuildChunkMeshFromVoxels(const GLubyte* voxels, chunk_mesh_mode mode, chunk_mesh* mesh) {
+    BuildChunkLodMeshFromVoxels(voxels, NULL, mode, 0, 0, mesh);
+}
+
+void BuildChunkLodMeshFromVoxels(const GLubyte* voxels, const GLubyte* light, chunk_mesh_mode mode, GLuint lod, GLuint seams, chunk_mesh* mesh) {
+    mesh->vertices_count = 0;
+    mesh->indices_count = 0;
+
+    const int scale = 1 << lod;
+    const int size = CHUNK_SIZE / scale;
+
+    // The common case meshes the snapshot as it is
+    GLubyte cells[CHUNK_PADDED_VOLUME];
+    const GLubyte* source = voxels;
+
+    if(lod > 0 || seams) {
+        BuildChunkCells(voxels, scale, seams, cells);
+        source = cells;
+    }
+
+    // Only coarse cells need their light merged, the light of the seams is still right
+    GLubyte light_cells[CHUNK_PADDED_VOLUME];
+    const GLubyte* light_source = light;
+
+    if(lod > 0 && light) {
+        BuildChunkLightCells(light, scale, light_cells);
+        light_source = light_cells;
+    }
+
+    // Full resolution passes constants, so the compiler can specialize the meshers for it
+    switch(mode) {
+        case CHUNK_MESH_NAIVE: {
+            if(lod == 0) {
+                BuildChunkMeshNaive(source, light_source, CHUNK_SIZE, 1, mesh);
+            } else {
+                BuildChunkMeshNaive(source, light_source, size, scale, mesh);
+            }
+        } break;
+
+        case CHUNK_MESH_GREEDY: {
+            if(lod == 0) {
+                BuildChunkMeshGreedy(source, light_source, CHUNK_SIZE, 1, mesh);
+            } else {
+                BuildChunkMeshGreedy(source, light_source, size, scale, mesh);
+            }
+        } break;
+    }
+}
+
+// Borders where the neighbour is meshed at another level of detail. Their surfaces don't line up, so both sides
+// build their faces on the border regardless of the neighbour, and these walls cover the cracks in between.
+static GLuint GetChunkSeams(chunk* chunk) {
+    // Coarse meshes always build them, their padding can't be known from the snapshot
+    if(chunk->lod > 0) {
+        return (1u << VOXEL_FACE_COUNT) - 1;
+    }
+
+    GLuint seams = 0;
+
+    for(int face = 0; face < VOXEL_FACE_COUNT; face++) {
+        if(chunk->neighbours[face] && chunk->neighbours[face]->lod != chunk->lod) {
+            seams |= 1u << face;
+        }
+    }
+
+    return seams;
+}
+
+void BuildChunkMesh(chunk* chunk) {
+    GLubyte* voxels = (GLubyte*) SDL_malloc(CHUNK_PADDED_VOLUME * 2);
+    if(!voxels) {
+        fprintf(stderr, "[ERR] CHUNK: Could not allocate the mesher voxels\n");
+
+        return;
+    }
+
+    GLubyte* light = voxels + CHUNK_PADDED_VOLUME;
+
+    CopyChunkVoxels(chunk, voxels);
+    CopyChunkMeshLight(chunk, light);
+    BuildChunkLodMeshFromVoxels(voxels, light, chunk->mesh_mode, chunk->lod, GetChunkSeams(chunk), &chunk->mesh);
+
+    SDL_free(voxels);
+
+    chunk->dirty = false;
+}
+
+bool ScheduleChunkMesh(chunk* chunk) {
+    if(chunk->mesh_job) {
+        return false;
+    }
+
+    chunk_mesh_job* mesh_job = (chunk_mesh_job*) SDL_calloc(1, sizeof(chunk_mesh_job));
+    if(!mesh_job) {
+        return false;
+    }
+
+    mesh_job->chunk = chunk;
+    mesh_job->mode = chunk->mesh_mode;
+    mesh_job->lod = chunk->lod;
+    mesh_job->seams = GetChunkSeams(chunk);
+    CopyChunkVoxels(chunk, mesh_job->voxels);
+    CopyChunkMeshLight(chunk, mesh_job->light);
+
+    if(!PushJob((job) { .function = ChunkMeshJob, .complete = ChunkMeshJobComplete, .data = mesh_job })) {
+        SDL_free(mesh_job);
+
+        return false;
+    }
+
+    chunk->mesh_job = mesh_job;
+    chunk->dirty = false;
+
+    return true;
+}
+
+void GenerateChunk(chunk* chunk, chunk_generator generator, const void* settings) {
+    GLubyte* voxels = (GLubyte*) SDL_malloc(CHUNK_VOLUME);
+    if(!voxels) {
+        fprintf(stderr, "[ERR] CHUNK: Could not allocate the generator voxels\n");
+
+        return;
+    }
+
+    int position[3] = { chunk->position[0], chunk->position[1], chunk->position[2] };
+
+    generator(settings, position, voxels);
+    SetChunkVoxels(chunk, voxels);
+    chunk->modified = false;
+
+    SDL_free(voxels);
+}
+
+bool ScheduleChunkGenerate(chunk* chunk, chunk_generator generator, const void* settings) {
+    if(chunk->generate_job) {
+        return false;
+    }
+
+    chunk_generate_job* generate_job = (chunk_generate_job*) SDL_malloc(sizeof(chunk_generate_job));
+    if(!generate_job) {
+        return false;
+    }
+
+    generate_job->chunk = chunk;
+    SDL_AtomicSet(&generate_job->cancelled, 0);
+    generate_job->generator = generator;
+    generate_job->settings = settings;
+    generate_job->position[0] = chunk->position[0];
+    generate_job->position[1] = chunk->position[1];
+    generate_job->position[2] = chunk->position[2];
+
+    if(!PushJob((job) { .function = ChunkGenerateJob, .complete = ChunkGenerateJobComplete, .data = generate_job })) {
+        SDL_free(generate_job);
+
+        return false;
+    }
+
+    chunk->generate_job = generate_job;
+
+    return true;
+}
+
+void UploadChunkMesh(chunk* chunk) {
+    WriteChunkArena(chunk);
+
+    // The GPU copy is now the only one needed for drawing
+    SDL_free(chunk->mesh.vertices);
+    SDL_free(chunk->mesh.indices);
+    chunk->mesh = (chunk_mesh) { 0 };
+}
+
+void RenderChunk(chunk* chunk) {
+    // Nothing worth meshing until the voxels arrive
+    if(chunk->generate_job) {
+        return;
+    }
+
+    // Meshing happens on the workers when there are any, the previous mesh is drawn until the new one is uploaded
+    if(chunk->dirty && !chunk->mesh_job) {
+        if(GetJobWorkersCount() > 0) {
+            ScheduleChunkMesh(chunk);
+        } else {
+            BuildChunkMesh(chunk);
+            UploadChunkMesh(chunk);
+        }
+    }
+
+    DrawChunk(chunk);
+}
+
+void DrawChunk(chunk* chunk) {
+    if(chunk->gpu.indices_count == 0) {
+        return;
+    }
+
+    vec3 chunk_offset = {
+        chunk->position[0] * CHUNK_SIZE * VOXEL_SIZE,
+        chunk->position[1] * CHUNK_SIZE * VOXEL_SIZE,
+        chunk->position[2] * CHUNK_SIZE * VOXEL_SIZE
+    };
+
+    vec3 chunk_box[2] = {
+        { chunk_offset[0], chunk_offset[1], chunk_offset[2] },
+        { chunk_offset[0] + CHUNK_SIZE * VOXEL_SIZE, chunk_offset[1] + CHUNK_SIZE * VOXEL_SIZE, chunk_offset[2] + CHUNK_SIZE * VOXEL_SIZE }
+    };
+
+    CORE.stats.current.chunks_tested++;
+    if(!glm_aabb_frustum(chunk_box, CORE.matrices.frustum)) {
+        CORE.stats.current.chunks_culled++;
+
+        return;
+    }
+
+    CORE.stats.current.chunks_drawn++;
+
+    // Drawn together with the other visible chunks by DrawChunkArena
+    QueueChunkArenaDraw(chunk);
+}
+
+void LoadChunkProgram(const GLchar* vertex_shader_filepath, const GLchar* fragment_shader_filepath) {
+    GLuint vertex_shader = CreateShader(vertex_shader_filepath, GL_VERTEX_SHADER);
+    GLuint fragment_shader = CreateShader(fragment_shader_filepath, GL_FRAGMENT_SHADER);
+
+    *GetChunkProgram() = CreateProgram(vertex_shader, fragment_shader);
+
+    // Constant for the lifetime of the program: voxel palette and face shading
+    UseRenderStateProgram(GetChunkProgram()->id);
+
+    SetShaderUniformFloat(GetShaderUniform(GetChunkProgram(), "uVoxelSize"), VOXEL_SIZE);
+    SetShaderUniformInt(GetShaderUniform(GetChunkProgram(), "uChunkOffsets"), CHUNK_ARENA_OFFSETS_TEXTURE_UNIT);
+
+    vec4 colors[VOXEL_TYPE_COUNT];
+    for(int type = 0; type < VOXEL_TYPE_COUNT; type++) {
+        GetVoxelColor(type, colors[type]);
+    }
+
+    SetShaderUniformVec4Array(GetShaderUniform(GetChunkProgram(), "uVoxelColors"), colors, VOXEL_TYPE_COUNT);
+
+    GLfloat shades[VOXEL_FACE_COUNT];
+    for(int face = 0; face < VOXEL_FACE_COUNT; face++) {
+        shades[face] = GetVoxelFaceShade(face);
+    }
+
+    SetShaderUniformFloatArray(GetShaderUniform(GetChunkProgram(), "uFaceShade"), shades, VOXEL_FACE_COUNT);
+}
+
+void UnloadChunkProgram() {
+    DeleteProgram(GetChunkProgram());
+}
@@ -0,0 +1,371 @@
+#include "chunk_arena.h"
+
+#include <stdio.h>
+
+#include "SDL2/SDL.h"
+
+#include "core.h"
+#include "render_state.h"
+#include "shader.h"
+#include "vertex_format.h"
+
+extern core_data CORE;
+
+// Both words of 'vert_packed' are read as integers and decoded in res/shaders/chunk_vertex.glsl
+static const vertex_format vert_packed_format = {
+    .stride = sizeof(vert_packed),
+    .attributes_count = 1,
+    .attributes = {
+        { 0, 2, GL_UNSIGNED_INT, VERTEX_ATTRIBUTE_INTEGER, 0 },
+    }
+};
+
+// glad only loads it for 4.3 contexts, the extension brings it to older ones
+static bool LoadChunkArenaIndirect() {
+    if(!SDL_GL_ExtensionSupported("GL_ARB_multi_draw_indirect")) {
+        return false;
+    }
+
+    if(!glMultiDrawElementsIndirect) {
+        glad_glMultiDrawElementsIndirect = (PFNGLMULTIDRAWELEMENTSINDIRECTPROC) SDL_GL_GetProcAddress("glMultiDrawElementsIndirect");
+    }
+
+    return glMultiDrawElementsIndirect != NULL;
+}
+
+static GLuint CreateChunkArenaBuffer(GLsizeiptr size) {
+    GLuint result = 0;
+    glGenBuffers(1, &result);
+
+    BindRenderStateBuffer(GL_COPY_WRITE_BUFFER, result);
+    glBufferData(GL_COPY_WRITE_BUFFER, size, NULL, GL_STATIC_DRAW);
+
+    return result;
+}
+
+// Moves the content of 'buffer' to a larger buffer on the GPU, without a round-trip through the CPU
+static void GrowChunkArenaBuffer(GLuint* buffer, GLsizeiptr size, GLsizeiptr size_new) {
+    GLuint result = CreateChunkArenaBuffer(size_new);
+
+    BindRenderStateBuffer(GL_COPY_READ_BUFFER, *buffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, size);
+
+    DeleteRenderStateBuffer(buffer);
+    *buffer = result;
+}
+
+// Compactions and growth replace the buffers, the VAO has to follow them
+static void UpdateChunkArenaVertexArray(GLuint vertex_buffer, GLuint index_buffer) {
+    chunk_arena* arena = &CORE.chunk_arena;
+
+    if(arena->vertices.buffer_id == vertex_buffer && arena->indices.buffer_id == index_buffer) {
+        return;
+    }
+
+    DeleteRenderStateVertexArray(&arena->vao_id);
+    arena->vao_id = CreateVertexArray(&vert_packed_format, arena->vertices.buffer_id, arena->indices.buffer_id);
+
+    printf("[INFO] ARENA: Chunk arena rebuilt | Vertices: %u | Indices: %u\n", arena->vertices.capacity, arena->indices.capacity);
+}
+
+// Hands the ranges of the chunk back to the allocators
+static void FreeChunkArenaGeometry(chunk* chunk) {
+    chunk_arena* arena = &CORE.chunk_arena;
+
+    if(chunk->gpu.vertices_count_max > 0) {
+        FreeGpuRange(&arena->vertices, &chunk->gpu.vertices_first);
+    }
+
+    if(chunk->gpu.indices_count_max > 0) {
+        FreeGpuRange(&arena->indices, &chunk->gpu.indices_first);
+    }
+
+    chunk->gpu.vertices_first = 0; chunk->gpu.vertices_count_max = 0;
+    chunk->gpu.indices_first = 0; chunk->gpu.indices_count_max = 0;
+}
+
+static GLuint AcquireChunkArenaSlot() {
+    chunk_arena* arena = &CORE.chunk_arena;
+
+    if(arena->free_slots_count > 0) {
+        return arena->free_slots[--arena->free_slots_count];
+    }
+
+    if(arena->slots_count == arena->slots_count_max) {
+        if(arena->slots_count_max == CHUNK_ARENA_SLOTS_MAX) {
+            fprintf(stderr, "[ERR] ARENA: Out of chunk slots\n");
+
+            return 0;
+        }
+
+        GLuint count_max = arena->slots_count_max * 2;
+        if(count_max > CHUNK_ARENA_SLOTS_MAX) {
+            count_max = CHUNK_ARENA_SLOTS_MAX;
+        }
+
+        GLuint* free_slots = (GLuint*) SDL_realloc(arena->free_slots, count_max * sizeof(GLuint));
+        if(!free_slots) {
+            fprintf(stderr, "[ERR] ARENA: Could not grow the free slots\n");
+
+            return 0;
+        }
+
+        arena->free_slots = free_slots;
+
+        GrowChunkArenaBuffer(&arena->offsets_buffer_id, arena->slots_count_max * sizeof(vec4), count_max * sizeof(vec4));
+        arena->slots_count_max = count_max;
+
+        glBindTexture(GL_TEXTURE_BUFFER, arena->offsets_texture_id);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, arena->offsets_buffer_id);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+    }
+
+    return arena->slots_count++;
+}
+
+static bool ReserveChunkArenaCommands() {
+    chunk_arena* arena = &CORE.chunk_arena;
+
+    if(arena->commands_count < arena->commands_count_max) {
+        return true;
+    }
+
+    GLuint count_max = arena->commands_count_max ? arena->commands_count_max * 2 : 256;
+
+    chunk** draw_chunks = (chunk**) SDL_realloc(arena->draw_chunks, count_max * sizeof(chunk*));
+    chunk_draw_command* commands = (chunk_draw_command*) SDL_realloc(arena->commands, count_max * sizeof(chunk_draw_command));
+    GLsizei* draw_counts = (GLsizei*) SDL_realloc(arena->draw_counts, count_max * sizeof(GLsizei));
+    void** draw_offsets = (void**) SDL_realloc(arena->draw_offsets, count_max * sizeof(void*));
+    GLint* draw_base_vertices = (GLint*) SDL_realloc(arena->draw_base_vertices, count_max * sizeof(GLint));
+
+    // Whatever was reallocated successfully is kept, so nothing leaks
+    if(draw_chunks) arena->draw_chunks = draw_chunks;
+    if(commands) arena->commands = commands;
+    if(draw_counts) arena->draw_counts = draw_counts;
+    if(draw_offsets) arena->draw_offsets = draw_offsets;
+    if(draw_base_vertices) arena->draw_base_vertices = draw_base_vertices;
+
+    if(!draw_chunks || !commands || !draw_counts || !draw_offsets || !draw_base_vertices) {
+        fprintf(stderr, "[ERR] ARENA: Could not grow the draw commands\n");
+
+        return false;
+    }
+
+    arena->commands_count_max = count_max;
+
+    return true;
+}
+
+bool LoadChunkArena(GLuint vertices_count, GLuint indices_count) {
+    chunk_arena* arena = &CORE.chunk_arena;
+    *arena = (chunk_arena) { 0 };
+
+    if(!LoadGpuAllocator(&arena->vertices, sizeof(vert_packed), vertices_count) || !LoadGpuAllocator(&arena->indices, sizeof(GLuint), indices_count)) {
+        fprintf(stderr, "[ERR] ARENA: Could not create the chunk arena buffers\n");
+
+        return false;
+    }
+
+    arena->vao_id = CreateVertexArray(&vert_packed_format, arena->vertices.buffer_id, arena->indices.buffer_id);
+
+    arena->slots_count = 1;
+    arena->slots_count_max = 256;
+    arena->free_slots = (GLuint*) SDL_calloc(arena->slots_count_max, sizeof(GLuint));
+    if(!arena->free_slots) {
+        fprintf(stderr, "[ERR] ARENA: Could not allocate the free slots\n");
+
+        return false;
+    }
+
+    arena->offsets_buffer_id = CreateChunkArenaBuffer(arena->slots_count_max * sizeof(vec4));
+
+    glGenTextures(1, &arena->offsets_texture_id);
+    glBindTexture(GL_TEXTURE_BUFFER, arena->offsets_texture_id);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, arena->offsets_buffer_id);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+    arena->indirect = LoadChunkArenaIndirect();
+    if(arena->indirect) {
+        LoadStreamBuffer(&arena->command_stream, 1024 * sizeof(chunk_draw_command), sizeof(chunk_draw_command));
+    }
+
+    printf("[INFO] ARENA: Chunk arena created | Vertices: %u | Indices: %u | Indirect: %s\n", arena->vertices.capacity, arena->indices.capacity, arena->indirect ? "yes" : "no");
+
+    return true;
+}
+
+void UnloadChunkArena() {
+    chunk_arena* arena = &CORE.chunk_arena;
+
+    if(arena->indirect) {
+        UnloadStreamBuffer(&arena->command_stream);
+    }
+
+    glDeleteTextures(1, &arena->offsets_texture_id);
+    DeleteRenderStateBuffer(&arena->offsets_buffer_id);
+
+    DeleteRenderStateVertexArray(&arena->vao_id);
+    UnloadGpuAllocator(&arena->vertices);
+    UnloadGpuAllocator(&arena->indices);
+
+    SDL_free(arena->free_slots);
+    SDL_free(arena->draw_chunks);
+    SDL_free(arena->commands);
+    SDL_free(arena->draw_counts);
+    SDL_free(arena->draw_offsets);
+    SDL_free(arena->draw_base_vertices);
+
+    *arena = (chunk_arena) { 0 };
+}
+
+void WriteChunkArena(chunk* chunk) {
+    chunk_arena* arena = &CORE.chunk_arena;
+    chunk_mesh* mesh = &chunk->mesh;
+
+    if(!chunk->gpu.slot) {
+        chunk->gpu.slot = AcquireChunkArenaSlot();
+        if(!chunk->gpu.slot) {
+            chunk->gpu.indices_count = 0;
+
+            return;
+        }
+
+        vec4 offset = {
+            chunk->position[0] * CHUNK_SIZE * VOXEL_SIZE,
+            chunk->position[1] * CHUNK_SIZE * VOXEL_SIZE,
+            chunk->position[2] * CHUNK_SIZE * VOXEL_SIZE,
+            0.0f
+        };
+
+        BindRenderStateBuffer(GL_COPY_WRITE_BUFFER, arena->offsets_buffer_id);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, chunk->gpu.slot * sizeof(vec4), sizeof(vec4), offset);
+    }
+
+    // Reuse the ranges of the previous mesh when the new one fits without leaving most of them unused
+    bool vertices_fit = mesh->vertices_count <= chunk->gpu.vertices_count_max && mesh->vertices_count * 2 >= chunk->gpu.vertices_count_max;
+    bool indices_fit = mesh->indices_count <= chunk->gpu.indices_count_max && mesh->indices_count * 2 >= chunk->gpu.indices_count_max;
+
+    if(!vertices_fit || !indices_fit) {
+        GLuint vertex_buffer = arena->vertices.buffer_id;
+        GLuint index_buffer = arena->indices.buffer_id;
+
+        FreeChunkArenaGeometry(chunk);
+
+        bool allocated = true;
+
+        if(mesh->vertices_count > 0) {
+            allocated = AllocateGpuRange(&arena->vertices, mesh->vertices_count, &chunk->gpu.vertices_first);
+            chunk->gpu.vertices_count_max = allocated ? mesh->vertices_count : 0;
+        }
+
+        if(allocated && mesh->indices_count > 0) {
+            allocated = AllocateGpuRange(&arena->indices, mesh->indices_count, &chunk->gpu.indices_first);
+            chunk->gpu.indices_count_max = allocated ? mesh->indices_count : 0;
+        }
+
+        if(!allocated) {
+            FreeChunkArenaGeometry(chunk);
+        }
+
+        UpdateChunkArenaVertexArray(vertex_buffer, index_buffer);
+
+        if(!allocated) {
+            chunk->gpu.indices_count = 0;
+
+            return;
+        }
+    }
+
+    // Tag every vertex with the slot holding the chunk offset
+    for(GLuint index = 0; index < mesh->vertices_count; index++) {
+        mesh->vertices[index].type_light |= chunk->gpu.slot << VERT_PACKED_SLOT_SHIFT;
+    }
+
+    if(mesh->vertices_count > 0) {
+        BindRenderStateBuffer(GL_COPY_WRITE_BUFFER, arena->vertices.buffer_id);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, chunk->gpu.vertices_first * sizeof(vert_packed), mesh->vertices_count * sizeof(vert_packed), mesh->vertices);
+    }
+
+    if(mesh->indices_count > 0) {
+        BindRenderStateBuffer(GL_COPY_WRITE_BUFFER, arena->indices.buffer_id);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, chunk->gpu.indices_first * sizeof(GLuint), mesh->indices_count * sizeof(GLuint), mesh->indices);
+    }
+
+    chunk->gpu.indices_count = mesh->indices_count;
+}
+
+void ReleaseChunkArena(chunk* chunk) {
+    chunk_arena* arena = &CORE.chunk_arena;
+
+    GLuint vertex_buffer = arena->vertices.buffer_id;
+    GLuint index_buffer = arena->indices.buffer_id;
+
+    FreeChunkArenaGeometry(chunk);
+    UpdateChunkArenaVertexArray(vertex_buffer, index_buffer);
+
+    if(chunk->gpu.slot) {
+        arena->free_slots[arena->free_slots_count++] = chunk->gpu.slot;
+    }
+
+    SDL_memset(&chunk->gpu, 0, sizeof(chunk->gpu));
+}
+
+void QueueChunkArenaDraw(chunk* chunk) {
+    chunk_arena* arena = &CORE.chunk_arena;
+
+    if(!ReserveChunkArenaCommands()) {
+        return;
+    }
+
+    // Its ranges are only read by DrawChunkArena, an upload later in the frame can still move them
+    arena->draw_chunks[arena->commands_count++] = chunk;
+}
+
+void DrawChunkArena() {
+    chunk_arena* arena = &CORE.chunk_arena;
+
+    if(arena->commands_count == 0) {
+        return;
+    }
+
+    for(GLuint index = 0; index < arena->commands_count; index++) {
+        chunk* chunk = arena->draw_chunks[index];
+
+        // Indices are local to the mesh, the base vertex moves them to its range
+        arena->commands[index] = (chunk_draw_command) {
+            .count = chunk->gpu.indices_count,
+            .instance_count = 1,
+            .first_index = chunk->gpu.indices_first,
+            .base_vertex = chunk->gpu.vertices_first,
+            .base_instance = 0
+        };
+    }
+
+    UseRenderStateProgram(GetChunkProgram()->id);
+    BindRenderStateVertexArray(arena->vao_id);
+
+    glActiveTexture(GL_TEXTURE0 + CHUNK_ARENA_OFFSETS_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_BUFFER, arena->offsets_texture_id);
+    glActiveTexture(GL_TEXTURE0);
+
+    if(arena->indirect) {
+        GLintptr offset = PushStreamBuffer(&arena->command_stream, arena->commands, arena->commands_count * sizeof(chunk_draw_command));
+
+        if(offset >= 0) {
+            BindRenderStateBuffer(GL_DRAW_INDIRECT_BUFFER, arena->command_stream.buffer_id);
+            glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*) offset, arena->commands_count, 0);
+        }
+
+        AdvanceStreamBuffer(&arena->command_stream);
+    } else {
+        for(GLuint index = 0; index < arena->commands_count; index++) {
+            arena->draw_counts[index] = arena->commands[index].count;
+            arena->draw_offsets[index] = (void*) (GLintptr) (arena->commands[index].first_index * sizeof(GLuint));
+            arena->draw_base_vertices[index] = arena->commands[index].base_vertex;
+        }
+
+        glMultiDrawElementsBaseVertex(GL_TRIANGLES, arena->draw_counts, GL_UNSIGNED_INT, (const void* const*) arena->draw_offsets, arena->commands_count, arena->draw_base_vertices);
+    }
+
+    arena->commands_count = 0;
+}
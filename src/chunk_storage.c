@@ -0,0 +1,245 @@
+#include "chunk_storage.h"
+
+#include <stdio.h>
+
+#include "SDL2/SDL.h"
+
+static GLuint GetChunkStorageBits(GLuint palette_count) {
+    if(palette_count <= 1) return 0;
+    if(palette_count <= 2) return 1;
+    if(palette_count <= 4) return 2;
+    if(palette_count <= 16) return 4;
+
+    return 8;
+}
+
+static GLuint ReadChunkStorageIndex(const GLuint* indices, GLuint bits, GLuint index) {
+    GLuint per_word = 32 / bits;
+
+    return (indices[index / per_word] >> ((index % per_word) * bits)) & ((1u << bits) - 1);
+}
+
+static void WriteChunkStorageIndex(GLuint* indices, GLuint bits, GLuint index, GLuint value) {
+    GLuint per_word = 32 / bits;
+    GLuint shift = (index % per_word) * bits;
+    GLuint mask = ((1u << bits) - 1) << shift;
+
+    indices[index / per_word] = (indices[index / per_word] & ~mask) | (value << shift);
+}
+
+// Re-packs every index at 'bits', passing it through 'remap' (old palette index to new one)
+static bool RepackChunkStorage(chunk_storage* storage, GLuint bits, const GLubyte* remap) {
+    GLuint* indices = NULL;
+
+    if(bits > 0) {
+        indices = (GLuint*) SDL_calloc(storage->count * bits / 32, sizeof(GLuint));
+        if(!indices) {
+            fprintf(stderr, "[ERR] CHUNK: Could not allocate the voxel indices | Bits: %u\n", bits);
+
+            return false;
+        }
+
+        // A uniform chunk is all index 0, which the zeroed indices already are
+        if(storage->bits > 0) {
+            for(GLuint index = 0; index < storage->count; index++) {
+                GLuint value = ReadChunkStorageIndex(storage->indices, storage->bits, index);
+                WriteChunkStorageIndex(indices, bits, index, remap ? remap[value] : value);
+            }
+        }
+    }
+
+    SDL_free(storage->indices);
+    storage->indices = indices;
+    storage->bits = bits;
+
+    return true;
+}
+
+bool LoadChunkStorage(chunk_storage* storage, GLuint count, GLubyte type) {
+    *storage = (chunk_storage) { 0 };
+
+    storage->count = count;
+    storage->palette[0] = type;
+    storage->palette_count = 1;
+
+    return true;
+}
+
+void UnloadChunkStorage(chunk_storage* storage) {
+    SDL_free(storage->indices);
+
+    *storage = (chunk_storage) { 0 };
+}
+
+bool CopyChunkStorage(chunk_storage* destination, const chunk_storage* source) {
+    *destination = *source;
+
+    if(source->bits == 0) {
+        return true;
+    }
+
+    size_t size = source->count * source->bits / 32 * sizeof(GLuint);
+
+    destination->indices = (GLuint*) SDL_malloc(size);
+    if(!destination->indices) {
+        fprintf(stderr, "[ERR] CHUNK: Could not allocate the voxel indices | Bits: %u\n", source->bits);
+        *destination = (chunk_storage) { 0 };
+
+        return false;
+    }
+
+    SDL_memcpy(destination->indices, source->indices, size);
+
+    return true;
+}
+
+GLubyte GetChunkStorageVoxel(const chunk_storage* storage, GLuint index) {
+    if(storage->bits == 0) {
+        return storage->palette[0];
+    }
+
+    return storage->palette[ReadChunkStorageIndex(storage->indices, storage->bits, index)];
+}
+
+bool SetChunkStorageVoxel(chunk_storage* storage, GLuint index, GLubyte type) {
+    GLuint palette_index = 0;
+    while(palette_index < storage->palette_count && storage->palette[palette_index] != type) {
+        palette_index++;
+    }
+
+    if(palette_index == storage->palette_count) {
+        // The palette is full at the current width: widen the indices before adding the type
+        if(GetChunkStorageBits(storage->palette_count + 1) != storage->bits) {
+            if(!RepackChunkStorage(storage, GetChunkStorageBits(storage->palette_count + 1), NULL)) {
+                return false;
+            }
+        }
+
+        storage->palette[storage->palette_count++] = type;
+    }
+
+    if(storage->bits > 0) {
+        WriteChunkStorageIndex(storage->indices, storage->bits, index, palette_index);
+    }
+
+    return true;
+}
+
+void FillChunkStorage(chunk_storage* storage, GLubyte type) {
+    SDL_free(storage->indices);
+
+    storage->indices = NULL;
+    storage->bits = 0;
+    storage->palette[0] = type;
+    storage->palette_count = 1;
+}
+
+bool EncodeChunkStorage(chunk_storage* storage, const GLubyte* voxels) {
+    GLubyte palette[CHUNK_STORAGE_PALETTE_MAX];
+    GLubyte lookup[CHUNK_STORAGE_PALETTE_MAX]; // Voxel type to palette index
+    bool present[CHUNK_STORAGE_PALETTE_MAX] = { 0 };
+    GLuint palette_count = 0;
+
+    for(GLuint index = 0; index < storage->count; index++) {
+        GLubyte type = voxels[index];
+
+        if(!present[type]) {
+            present[type] = true;
+            lookup[type] = palette_count;
+            palette[palette_count++] = type;
+        }
+    }
+
+    GLuint bits = GetChunkStorageBits(palette_count);
+    GLuint* indices = NULL;
+
+    if(bits > 0) {
+        indices = (GLuint*) SDL_malloc(storage->count * bits / 32 * sizeof(GLuint));
+        if(!indices) {
+            fprintf(stderr, "[ERR] CHUNK: Could not allocate the voxel indices | Bits: %u\n", bits);
+
+            return false;
+        }
+
+        const GLuint per_word = 32 / bits;
+
+        for(GLuint word = 0; word < storage->count / per_word; word++) {
+            GLuint value = 0;
+
+            for(GLuint index = 0; index < per_word; index++) {
+                value |= (GLuint) lookup[voxels[word * per_word + index]] << (index * bits);
+            }
+
+            indices[word] = value;
+        }
+    }
+
+    SDL_free(storage->indices);
+    storage->indices = indices;
+    storage->bits = bits;
+    storage->palette_count = palette_count;
+    SDL_memcpy(storage->palette, palette, palette_count);
+
+    return true;
+}
+
+void DecodeChunkStorage(const chunk_storage* storage, GLuint first, GLuint count, GLubyte* voxels) {
+    if(storage->bits == 0) {
+        SDL_memset(voxels, storage->palette[0], count);
+
+        return;
+    }
+
+    // Whole words at a time: 32 voxels always cover a whole number of words
+    const GLuint bits = storage->bits;
+    const GLuint per_word = 32 / bits;
+    const GLuint mask = (1u << bits) - 1;
+
+    const GLuint* word = &storage->indices[first / per_word];
+    const GLuint* word_last = word + count / per_word;
+
+    for(; word < word_last; word++) {
+        GLuint value = *word;
+
+        for(GLuint index = 0; index < per_word; index++) {
+            *voxels++ = storage->palette[value & mask];
+            value >>= bits;
+        }
+    }
+}
+
+void ShrinkChunkStorage(chunk_storage* storage) {
+    if(storage->bits == 0) {
+        return;
+    }
+
+    bool used[CHUNK_STORAGE_PALETTE_MAX] = { 0 };
+    for(GLuint index = 0; index < storage->count; index++) {
+        used[ReadChunkStorageIndex(storage->indices, storage->bits, index)] = true;
+    }
+
+    GLubyte remap[CHUNK_STORAGE_PALETTE_MAX] = { 0 };
+    GLubyte palette[CHUNK_STORAGE_PALETTE_MAX];
+    GLuint palette_count = 0;
+
+    for(GLuint index = 0; index < storage->palette_count; index++) {
+        if(used[index]) {
+            remap[index] = palette_count;
+            palette[palette_count++] = storage->palette[index];
+        }
+    }
+
+    // Nothing to gain when every entry is still in use
+    if(palette_count == storage->palette_count) {
+        return;
+    }
+
+    if(RepackChunkStorage(storage, GetChunkStorageBits(palette_count), remap)) {
+        SDL_memcpy(storage->palette, palette, palette_count);
+        storage->palette_count = palette_count;
+    }
+}
+
+size_t GetChunkStorageBytes(const chunk_storage* storage) {
+    return storage->bits > 0 ? storage->count * storage->bits / 8 : 0;
+}
@@ -5,9 +5,13 @@
 
 #include "render_batch.h"
 #include "input.h" 
+#include "job.h"
 
 core_data CORE = { 0 };
 
+// 'frame_uniforms' is uploaded as-is into a std140 block: 3 matrices + 1 vec4 + (vec2, float) padded to a vec4
+typedef char frame_uniforms_layout_check[sizeof(frame_uniforms) == (3 * 16 + 4 + 4) * sizeof(GLfloat) ? 1 : -1];
+
 void CreateWindow(ivec2 size, const GLchar* title) {
     if(SDL_Init(SDL_INIT_EVERYTHING) != 0) {
         fprintf(stderr, "[ERR] %s\n", SDL_GetError());
@@ -33,6 +37,14 @@ void CreateWindow(ivec2 size, const GLchar* title) {
     SDL_GL_MakeCurrent(CORE.window_context.window, CORE.window_context.context);
     gladLoadGL();
 
+    // One buffer for the per-frame data of every program, bound once and rewritten by UpdateFrameUniforms
+    ResetRenderState();
+
+    glGenBuffers(1, &CORE.frame.ubo_id);
+    BindRenderStateBuffer(GL_UNIFORM_BUFFER, CORE.frame.ubo_id);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(frame_uniforms), NULL, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, SHADER_FRAME_BINDING, CORE.frame.ubo_id); // Also the generic binding, as cached
+
     printf("[INFO] SDL: Version: %i.%i.%i\n", SDL_MAJOR_VERSION, SDL_MINOR_VERSION, SDL_PATCHLEVEL);
     printf("[INFO] OPENGL: Version: %s\n", glGetString(GL_VERSION));
 
@@ -40,6 +52,8 @@ void CreateWindow(ivec2 size, const GLchar* title) {
 }
 
 void CloseWindow() {
+    DeleteRenderStateBuffer(&CORE.frame.ubo_id);
+
     printf("[INFO] OPENGL: Closing an OpenGL context\n");
     SDL_GL_DeleteContext(CORE.window_context.context);
 
@@ -129,30 +143,39 @@ void Clear(vec4 color) {
 }
 
 void BeginRenderMode(camera* camera) {
+    // Completion callbacks upload GPU resources (e.g. chunk meshes), so they run where the context is current
+    UpdateJobs();
+
     glViewport(0, 0, CORE.window_context.window_size[0], CORE.window_context.window_size[1]);
 
+    // Uniforms go to the bound program and chunks are drawn before the batch is flushed
+    UseRenderStateProgram(CORE.shaders.shader_program.id);
+
+    CORE.stats.previous = CORE.stats.current;
+    CORE.stats.current = (render_stats) { 0 };
+
     if(camera != NULL) {
         CameraMatrix(camera);
+        SDL_memcpy(CORE.matrices.frustum, camera->frustum, sizeof(CORE.matrices.frustum));
     } else {
         DefaultMatrix();
     }
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    // Only the first frame (or a frame after something else changed them) actually reaches OpenGL
+    SetRenderStateCapability(GL_BLEND, true);
+    SetRenderStateBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    glEnable(GL_DEPTH_TEST);
+    SetRenderStateCapability(GL_DEPTH_TEST, true);
     
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_FRONT);
-    glFrontFace(GL_CCW);
+    SetRenderStateCapability(GL_CULL_FACE, true);
+    SetRenderStateCullFace(GL_FRONT);
+    SetRenderStateFrontFace(GL_CCW);
 }
 
 void EndRenderMode() {
+    DrawChunkArena();
     DrawRenderBatch();
 
-    glDisable(GL_BLEND);
-    glDisable(GL_CULL_FACE);
-
     SDL_GL_SwapWindow(CORE.window_context.window);
     PollEvents();
 }
@@ -162,8 +185,32 @@ void DefaultMatrix() {
     glm_mat4_identity(CORE.matrices.view);
 
     glm_perspective(glm_rad(45.0f), (float) (CORE.window_context.window_size[0]) / (float) (CORE.window_context.window_size[1]), 0.001f, 16384.0f, CORE.matrices.projection);
-    glUniformMatrix4fv(CORE.matrices.shader_loc_projection, 1, GL_FALSE, &CORE.matrices.projection[0][0]);
-
     glm_translate(CORE.matrices.view, (vec3) { 0 });        
-    glUniformMatrix4fv(CORE.matrices.shader_loc_view, 1, GL_FALSE, &CORE.matrices.view[0][0]);
+
+    UpdateFrameUniforms(CORE.matrices.projection, CORE.matrices.view, (vec3) { 0 });
+    glm_frustum_planes(CORE.frame.data.view_projection, CORE.matrices.frustum);
+}
+
+void UpdateFrameUniforms(mat4 projection, mat4 view, vec3 camera_position) {
+    frame_uniforms* data = &CORE.frame.data;
+
+    glm_mat4_copy(view, data->view);
+    glm_mat4_copy(projection, data->projection);
+    glm_mat4_mul(projection, view, data->view_projection);
+
+    data->camera_position[0] = camera_position[0];
+    data->camera_position[1] = camera_position[1];
+    data->camera_position[2] = camera_position[2];
+    data->camera_position[3] = 1.0f;
+
+    data->viewport_size[0] = CORE.window_context.window_size[0];
+    data->viewport_size[1] = CORE.window_context.window_size[1];
+    data->time = SDL_GetTicks() / 1000.0f;
+
+    BindRenderStateBuffer(GL_UNIFORM_BUFFER, CORE.frame.ubo_id);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(frame_uniforms), data);
+}
+
+render_stats GetRenderStats() {
+    return CORE.stats.previous;
 }
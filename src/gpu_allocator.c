@@ -0,0 +1,295 @@
+#include "gpu_allocator.h"
+
+#include <stdio.h>
+
+#include "SDL2/SDL.h"
+
+#include "render_state.h"
+
+static bool ReserveGpuAllocatorArray(void** array, GLuint* count_max, GLuint count, size_t element_size) {
+    if(count <= *count_max) {
+        return true;
+    }
+
+    GLuint count_max_new = *count_max ? *count_max : 64;
+    while(count_max_new < count) {
+        count_max_new *= 2;
+    }
+
+    void* result = SDL_realloc(*array, count_max_new * element_size);
+    if(!result) {
+        fprintf(stderr, "[ERR] GPU_ALLOCATOR: Could not grow the bookkeeping\n");
+
+        return false;
+    }
+
+    *array = result;
+    *count_max = count_max_new;
+
+    return true;
+}
+
+// Index of the first allocation at or after 'offset'
+static GLuint FindGpuAllocation(gpu_allocator* allocator, GLuint offset) {
+    GLuint low = 0;
+    GLuint high = allocator->allocations_count;
+
+    while(low < high) {
+        GLuint middle = (low + high) / 2;
+
+        if(allocator->allocations[middle].offset < offset) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+// The last free range ending at the capacity is the tail, every other free range is a hole
+static GLuint GetGpuAllocatorHoles(const gpu_allocator* allocator) {
+    GLuint free = 0;
+
+    for(GLuint index = 0; index < allocator->free_ranges_count; index++) {
+        free += allocator->free_ranges[index].size;
+    }
+
+    if(allocator->free_ranges_count > 0) {
+        gpu_range* tail = &allocator->free_ranges[allocator->free_ranges_count - 1];
+
+        if(tail->offset + tail->size == allocator->capacity) {
+            free -= tail->size;
+        }
+    }
+
+    return free;
+}
+
+// Packs every live range at the start of a new buffer of 'capacity' elements, copying on the GPU
+static bool RebuildGpuAllocator(gpu_allocator* allocator, GLuint capacity) {
+    if(!ReserveGpuAllocatorArray((void**) &allocator->free_ranges, &allocator->free_ranges_count_max, 1, sizeof(gpu_range))) {
+        return false;
+    }
+
+    GLuint buffer_id = 0;
+    glGenBuffers(1, &buffer_id);
+
+    BindRenderStateBuffer(GL_COPY_WRITE_BUFFER, buffer_id);
+    glBufferData(GL_COPY_WRITE_BUFFER, capacity * allocator->element_size, NULL, GL_STATIC_DRAW);
+
+    BindRenderStateBuffer(GL_COPY_READ_BUFFER, allocator->buffer_id);
+
+    // Ranges that stay contiguous are moved with a single copy
+    GLuint cursor = 0;
+    GLuint run_source = 0;
+    GLuint run_destination = 0;
+    GLuint run_size = 0;
+
+    for(GLuint index = 0; index < allocator->allocations_count; index++) {
+        gpu_allocation* allocation = &allocator->allocations[index];
+
+        if(run_size > 0 && allocation->offset != run_source + run_size) {
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, run_source * allocator->element_size, run_destination * allocator->element_size, run_size * allocator->element_size);
+            run_size = 0;
+        }
+
+        if(run_size == 0) {
+            run_source = allocation->offset;
+            run_destination = cursor;
+        }
+
+        run_size += allocation->size;
+
+        allocation->offset = cursor;
+        *allocation->owner = cursor;
+        cursor += allocation->size;
+    }
+
+    if(run_size > 0) {
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, run_source * allocator->element_size, run_destination * allocator->element_size, run_size * allocator->element_size);
+    }
+
+    // Draws still reading the old buffer keep it alive until they are done
+    DeleteRenderStateBuffer(&allocator->buffer_id);
+
+    allocator->buffer_id = buffer_id;
+    allocator->capacity = capacity;
+
+    allocator->free_ranges_count = 0;
+    if(cursor < capacity) {
+        allocator->free_ranges[allocator->free_ranges_count++] = (gpu_range) { .offset = cursor, .size = capacity - cursor };
+    }
+
+    return true;
+}
+
+bool LoadGpuAllocator(gpu_allocator* allocator, GLsizeiptr element_size, GLuint capacity) {
+    *allocator = (gpu_allocator) { 0 };
+
+    allocator->element_size = element_size;
+    allocator->capacity = capacity > 0 ? capacity : 1;
+
+    if(!ReserveGpuAllocatorArray((void**) &allocator->free_ranges, &allocator->free_ranges_count_max, 1, sizeof(gpu_range))) {
+        return false;
+    }
+
+    allocator->free_ranges[allocator->free_ranges_count++] = (gpu_range) { .offset = 0, .size = allocator->capacity };
+
+    glGenBuffers(1, &allocator->buffer_id);
+    BindRenderStateBuffer(GL_COPY_WRITE_BUFFER, allocator->buffer_id);
+    glBufferData(GL_COPY_WRITE_BUFFER, allocator->capacity * element_size, NULL, GL_STATIC_DRAW);
+
+    return true;
+}
+
+void UnloadGpuAllocator(gpu_allocator* allocator) {
+    DeleteRenderStateBuffer(&allocator->buffer_id);
+
+    SDL_free(allocator->free_ranges);
+    SDL_free(allocator->allocations);
+
+    *allocator = (gpu_allocator) { 0 };
+}
+
+bool AllocateGpuRange(gpu_allocator* allocator, GLuint size, GLuint* owner) {
+    // Once everything is freed the holes have merged back into the whole buffer, there is nothing to move
+    if(allocator->compact_pending && allocator->live > 0) {
+        CompactGpuAllocator(allocator);
+    }
+
+    allocator->compact_pending = false;
+
+    if(!ReserveGpuAllocatorArray((void**) &allocator->allocations, &allocator->allocations_count_max, allocator->allocations_count + 1, sizeof(gpu_allocation))) {
+        return false;
+    }
+
+    GLuint range_index = allocator->free_ranges_count;
+    for(GLuint index = 0; index < allocator->free_ranges_count; index++) {
+        if(allocator->free_ranges[index].size >= size) {
+            range_index = index;
+
+            break;
+        }
+    }
+
+    // Nothing fits: pack the holes away, and make the buffer larger if that's still not enough
+    if(range_index == allocator->free_ranges_count) {
+        GLuint capacity = allocator->capacity;
+        while(capacity - allocator->live < size) {
+            capacity *= 2;
+        }
+
+        if(capacity != allocator->capacity) {
+            allocator->grows++;
+        } else {
+            allocator->compactions++;
+        }
+
+        if(!RebuildGpuAllocator(allocator, capacity)) {
+            return false;
+        }
+
+        range_index = 0;
+    }
+
+    gpu_range* range = &allocator->free_ranges[range_index];
+    GLuint offset = range->offset;
+
+    range->offset += size;
+    range->size -= size;
+
+    if(range->size == 0) {
+        SDL_memmove(range, range + 1, (allocator->free_ranges_count - range_index - 1) * sizeof(gpu_range));
+        allocator->free_ranges_count--;
+    }
+
+    GLuint allocation_index = FindGpuAllocation(allocator, offset);
+    SDL_memmove(&allocator->allocations[allocation_index + 1], &allocator->allocations[allocation_index], (allocator->allocations_count - allocation_index) * sizeof(gpu_allocation));
+    allocator->allocations[allocation_index] = (gpu_allocation) { .offset = offset, .size = size, .owner = owner };
+    allocator->allocations_count++;
+
+    allocator->live += size;
+    allocator->allocations_total++;
+
+    *owner = offset;
+
+    return true;
+}
+
+void FreeGpuRange(gpu_allocator* allocator, GLuint* owner) {
+    GLuint allocation_index = FindGpuAllocation(allocator, *owner);
+    if(allocation_index == allocator->allocations_count || allocator->allocations[allocation_index].owner != owner) {
+        fprintf(stderr, "[WARN] GPU_ALLOCATOR: Freeing a range that wasn't allocated | Offset: %u\n", *owner);
+
+        return;
+    }
+
+    gpu_range freed = { .offset = allocator->allocations[allocation_index].offset, .size = allocator->allocations[allocation_index].size };
+
+    SDL_memmove(&allocator->allocations[allocation_index], &allocator->allocations[allocation_index + 1], (allocator->allocations_count - allocation_index - 1) * sizeof(gpu_allocation));
+    allocator->allocations_count--;
+
+    allocator->live -= freed.size;
+    allocator->frees_total++;
+
+    // Insert in offset order, merging with the free neighbours
+    GLuint range_index = 0;
+    while(range_index < allocator->free_ranges_count && allocator->free_ranges[range_index].offset < freed.offset) {
+        range_index++;
+    }
+
+    bool merge_previous = range_index > 0 && allocator->free_ranges[range_index - 1].offset + allocator->free_ranges[range_index - 1].size == freed.offset;
+    bool merge_next = range_index < allocator->free_ranges_count && freed.offset + freed.size == allocator->free_ranges[range_index].offset;
+
+    if(merge_previous && merge_next) {
+        allocator->free_ranges[range_index - 1].size += freed.size + allocator->free_ranges[range_index].size;
+
+        SDL_memmove(&allocator->free_ranges[range_index], &allocator->free_ranges[range_index + 1], (allocator->free_ranges_count - range_index - 1) * sizeof(gpu_range));
+        allocator->free_ranges_count--;
+    } else if(merge_previous) {
+        allocator->free_ranges[range_index - 1].size += freed.size;
+    } else if(merge_next) {
+        allocator->free_ranges[range_index].offset = freed.offset;
+        allocator->free_ranges[range_index].size += freed.size;
+    } else {
+        if(!ReserveGpuAllocatorArray((void**) &allocator->free_ranges, &allocator->free_ranges_count_max, allocator->free_ranges_count + 1, sizeof(gpu_range))) {
+            return; // The range is lost until the next compaction
+        }
+
+        SDL_memmove(&allocator->free_ranges[range_index + 1], &allocator->free_ranges[range_index], (allocator->free_ranges_count - range_index) * sizeof(gpu_range));
+        allocator->free_ranges[range_index] = freed;
+        allocator->free_ranges_count++;
+    }
+
+    // Left to the next allocation, so a burst of frees (e.g. unloading the world) doesn't copy the buffer over and over
+    if(GetGpuAllocatorHoles(allocator) > allocator->capacity * GPU_ALLOCATOR_COMPACT_THRESHOLD) {
+        allocator->compact_pending = true;
+    }
+}
+
+void CompactGpuAllocator(gpu_allocator* allocator) {
+    allocator->compact_pending = false;
+
+    if(GetGpuAllocatorHoles(allocator) == 0) {
+        return;
+    }
+
+    if(RebuildGpuAllocator(allocator, allocator->capacity)) {
+        allocator->compactions++;
+    }
+}
+
+gpu_allocator_stats GetGpuAllocatorStats(const gpu_allocator* allocator) {
+    return (gpu_allocator_stats) {
+        .live_bytes = allocator->live * allocator->element_size,
+        .wasted_bytes = GetGpuAllocatorHoles(allocator) * allocator->element_size,
+        .capacity_bytes = allocator->capacity * allocator->element_size,
+
+        .allocations_count = allocator->allocations_count,
+        .allocations_total = allocator->allocations_total,
+        .frees_total = allocator->frees_total,
+        .compactions = allocator->compactions,
+        .grows = allocator->grows
+    };
+}
@@ -0,0 +1,227 @@
+#include "job.h"
+
+#include <stdio.h>
+
+#include "SDL2/SDL.h"
+
+#include "core.h"
+
+extern core_data CORE;
+
+static bool LoadJobQueue(job_queue* queue, GLuint capacity) {
+    queue->cells = (job_cell*) SDL_calloc(capacity, sizeof(job_cell));
+    if(!queue->cells) {
+        return false;
+    }
+
+    for(GLuint cell = 0; cell < capacity; cell++) {
+        SDL_AtomicSet(&queue->cells[cell].sequence, cell);
+    }
+
+    queue->mask = capacity - 1;
+    SDL_AtomicSet(&queue->enqueue_position, 0);
+    SDL_AtomicSet(&queue->dequeue_position, 0);
+
+    return true;
+}
+
+static void UnloadJobQueue(job_queue* queue) {
+    SDL_free(queue->cells);
+    queue->cells = NULL;
+}
+
+// Bounded MPMC queue (D. Vyukov): every cell carries a sequence number telling
+// producers and consumers whether it's their turn, so no locks are needed.
+// Positions are compared as unsigned differences so they can safely wrap around.
+static bool EnqueueJob(job_queue* queue, job job) {
+    job_cell* cell;
+    GLuint position = SDL_AtomicGet(&queue->enqueue_position);
+
+    for(;;) {
+        cell = &queue->cells[position & queue->mask];
+        int difference = (int) ((GLuint) SDL_AtomicGet(&cell->sequence) - position);
+
+        if(difference == 0) {
+            if(SDL_AtomicCAS(&queue->enqueue_position, position, position + 1)) {
+                break;
+            }
+
+            position = SDL_AtomicGet(&queue->enqueue_position);
+        } else if(difference < 0) {
+            return false; // Full
+        } else {
+            position = SDL_AtomicGet(&queue->enqueue_position);
+        }
+    }
+
+    cell->job = job;
+
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&cell->sequence, position + 1);
+
+    return true;
+}
+
+static bool DequeueJob(job_queue* queue, job* job) {
+    job_cell* cell;
+    GLuint position = SDL_AtomicGet(&queue->dequeue_position);
+
+    for(;;) {
+        cell = &queue->cells[position & queue->mask];
+        int difference = (int) ((GLuint) SDL_AtomicGet(&cell->sequence) - (position + 1));
+
+        if(difference == 0) {
+            if(SDL_AtomicCAS(&queue->dequeue_position, position, position + 1)) {
+                break;
+            }
+
+            position = SDL_AtomicGet(&queue->dequeue_position);
+        } else if(difference < 0) {
+            return false; // Empty
+        } else {
+            position = SDL_AtomicGet(&queue->dequeue_position);
+        }
+    }
+
+    SDL_MemoryBarrierAcquire();
+    *job = cell->job;
+
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&cell->sequence, position + queue->mask + 1);
+
+    return true;
+}
+
+static int JobWorker(void* data) {
+    for(;;) {
+        SDL_SemWait(CORE.jobs.queue_semaphore);
+
+        if(SDL_AtomicGet(&CORE.jobs.quit)) {
+            break;
+        }
+
+        // The semaphore is posted after the job is published, so this only
+        // spins if another worker is in the middle of the same dequeue
+        job job;
+        while(!DequeueJob(&CORE.jobs.queue, &job)) {
+            SDL_Delay(0);
+        }
+
+        job.function(job.data);
+
+        // Can't fail: PushJob never lets more than JOB_QUEUE_CAPACITY jobs be in flight
+        EnqueueJob(&CORE.jobs.completed, job);
+    }
+
+    return 0;
+}
+
+void LoadJobSystem(GLuint workers_count) {
+    if(workers_count == 0) {
+        workers_count = SDL_max(SDL_GetCPUCount() - 1, 1);
+    }
+
+    if(!LoadJobQueue(&CORE.jobs.queue, JOB_QUEUE_CAPACITY) || !LoadJobQueue(&CORE.jobs.completed, JOB_QUEUE_CAPACITY)) {
+        fprintf(stderr, "[ERR] JOBS: Could not allocate the job queues\n");
+        UnloadJobQueue(&CORE.jobs.queue);
+        UnloadJobQueue(&CORE.jobs.completed);
+
+        return;
+    }
+
+    CORE.jobs.queue_semaphore = SDL_CreateSemaphore(0);
+    SDL_AtomicSet(&CORE.jobs.pending, 0);
+    SDL_AtomicSet(&CORE.jobs.quit, 0);
+
+    CORE.jobs.workers = (SDL_Thread**) SDL_calloc(workers_count, sizeof(SDL_Thread*));
+    CORE.jobs.workers_count = 0;
+
+    for(GLuint worker = 0; worker < workers_count; worker++) {
+        CORE.jobs.workers[worker] = SDL_CreateThread(JobWorker, "JobWorker", NULL);
+        if(!CORE.jobs.workers[worker]) {
+            fprintf(stderr, "[ERR] JOBS: %s\n", SDL_GetError());
+
+            break;
+        }
+
+        CORE.jobs.workers_count++;
+    }
+
+    printf("[INFO] JOBS: Started the job system | Workers: %u\n", CORE.jobs.workers_count);
+}
+
+void UnloadJobSystem() {
+    if(!CORE.jobs.workers) {
+        return;
+    }
+
+    WaitJobs();
+
+    SDL_AtomicSet(&CORE.jobs.quit, 1);
+    for(GLuint worker = 0; worker < CORE.jobs.workers_count; worker++) {
+        SDL_SemPost(CORE.jobs.queue_semaphore);
+    }
+
+    for(GLuint worker = 0; worker < CORE.jobs.workers_count; worker++) {
+        SDL_WaitThread(CORE.jobs.workers[worker], NULL);
+    }
+
+    SDL_free(CORE.jobs.workers);
+    CORE.jobs.workers = NULL;
+    CORE.jobs.workers_count = 0;
+
+    SDL_DestroySemaphore(CORE.jobs.queue_semaphore);
+    UnloadJobQueue(&CORE.jobs.queue);
+    UnloadJobQueue(&CORE.jobs.completed);
+
+    printf("[INFO] JOBS: Stopped the job system\n");
+}
+
+bool PushJob(job job) {
+    if(CORE.jobs.workers_count == 0) {
+        return false;
+    }
+
+    // Only the main thread pushes, so checking before incrementing is enough
+    if(SDL_AtomicGet(&CORE.jobs.pending) >= JOB_QUEUE_CAPACITY) {
+        return false;
+    }
+
+    SDL_AtomicIncRef(&CORE.jobs.pending);
+
+    if(!EnqueueJob(&CORE.jobs.queue, job)) {
+        SDL_AtomicAdd(&CORE.jobs.pending, -1);
+
+        return false;
+    }
+
+    SDL_SemPost(CORE.jobs.queue_semaphore);
+
+    return true;
+}
+
+void UpdateJobs() {
+    if(CORE.jobs.workers_count == 0) {
+        return;
+    }
+
+    job job;
+    while(DequeueJob(&CORE.jobs.completed, &job)) {
+        if(job.complete) {
+            job.complete(job.data);
+        }
+
+        SDL_AtomicAdd(&CORE.jobs.pending, -1);
+    }
+}
+
+void WaitJobs() {
+    while(SDL_AtomicGet(&CORE.jobs.pending) > 0) {
+        UpdateJobs();
+        SDL_Delay(1);
+    }
+}
+
+GLuint GetJobWorkersCount() {
+    return CORE.jobs.workers_count;
+}
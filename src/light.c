@@ -0,0 +1,603 @@
+#include "light.h"
+
+#include <stdio.h>
+
+#include "SDL2/SDL.h"
+#include "glad/glad.h"
+
+#include "chunk.h"
+#include "job.h"
+#include "voxel.h"
+
+#define LIGHT_EVENTS_COUNT_MIN 64
+
+typedef struct {
+    GLuint index; // CHUNK_PADDED_INDEX of the voxel
+    GLubyte level; // Light the voxel had when it was unlit, for the removal queue
+} light_node;
+
+// FIFO of voxels for the flood fill, emptied by advancing 'first'
+typedef struct {
+    light_node* nodes; GLuint first; GLuint count; GLuint count_max;
+} light_queue;
+
+typedef struct {
+    light_event* events; GLuint count; GLuint count_max;
+} light_events;
+
+struct chunk_light_job {
+    chunk* chunk; // NULL once the chunk was unloaded while the job was running
+    bool sky;
+    bool reset;
+
+    light_event* events; GLuint events_count; // Taken over from the chunk when the job was scheduled
+
+    GLubyte voxels[CHUNK_PADDED_VOLUME]; // Snapshots taken when the job was scheduled
+    GLubyte light[CHUNK_PADDED_VOLUME];
+    GLubyte light_before[CHUNK_PADDED_VOLUME];
+
+    light_queue removals; // Unlit voxels whose neighbours may have got their light from them
+    light_queue additions; // Lit voxels to spread from
+
+    light_events outgoing[VOXEL_FACE_COUNT]; // Events for the neighbours, queued to them once the job completes
+    bool failed; // Ran out of memory, the chunk relights from scratch next time
+
+    bool changed; // The light of the chunk differs from before the job
+    GLuint borders; // Mask of (1 << voxel_face) where the light of the border voxels changed
+    GLubyte result[CHUNK_VOLUME];
+    chunk_storage storage; // 'result' compressed on the worker, swapped into the chunk when it completes
+};
+
+// Offset to the adjacent voxel in the padded snapshot for every voxel_face
+static const int light_face_offsets[VOXEL_FACE_COUNT] = {
+    CHUNK_PADDED_SIZE * CHUNK_PADDED_SIZE, // Face: UP
+    -CHUNK_PADDED_SIZE * CHUNK_PADDED_SIZE, // Face: DOWN
+    CHUNK_PADDED_SIZE, // Face: FRONT
+    -CHUNK_PADDED_SIZE, // Face: BACK
+    -1, // Face: LEFT
+    1, // Face: RIGHT
+};
+
+static void GetLightPosition(GLuint index, int position[3]) {
+    position[0] = (int) (index % CHUNK_PADDED_SIZE) - 1;
+    position[1] = (int) (index / (CHUNK_PADDED_SIZE * CHUNK_PADDED_SIZE)) - 1;
+    position[2] = (int) (index / CHUNK_PADDED_SIZE % CHUNK_PADDED_SIZE) - 1;
+}
+
+static bool IsLightInside(const int position[3]) {
+    return
+        position[0] >= 0 && position[0] < CHUNK_SIZE &&
+        position[1] >= 0 && position[1] < CHUNK_SIZE &&
+        position[2] >= 0 && position[2] < CHUNK_SIZE;
+}
+
+static GLuint GetLightLevel(const GLubyte* light, GLuint index, light_channel channel) {
+    return channel == LIGHT_CHANNEL_SUN ? LIGHT_SUN(light[index]) : LIGHT_BLOCK(light[index]);
+}
+
+static void SetLightLevel(GLubyte* light, GLuint index, light_channel channel, GLuint level) {
+    light[index] = channel == LIGHT_CHANNEL_SUN ? LIGHT_PACK(level, LIGHT_BLOCK(light[index])) : LIGHT_PACK(LIGHT_SUN(light[index]), level);
+}
+
+// Light reaching the adjacent voxel from a voxel of 'level': sunlight keeps its full level straight down
+static GLuint GetLightSpread(light_channel channel, voxel_face face, GLuint level) {
+    if(channel == LIGHT_CHANNEL_SUN && face == VOXEL_FACE_DOWN && level == LIGHT_LEVEL_MAX) {
+        return LIGHT_LEVEL_MAX;
+    }
+
+    return level > 0 ? level - 1 : 0;
+}
+
+// A voxel of 'level' next to a voxel of 'source' (on its 'face' side, seen from the source) may have got its light from it
+static bool IsLightDependent(light_channel channel, voxel_face face, GLuint source, GLuint level) {
+    if(level == 0) {
+        return false;
+    }
+
+    return level < source || (channel == LIGHT_CHANNEL_SUN && face == VOXEL_FACE_DOWN && source == LIGHT_LEVEL_MAX && level == LIGHT_LEVEL_MAX);
+}
+
+static bool PushLightNode(chunk_light_job* job, light_queue* queue, GLuint index, GLuint level) {
+    if(queue->count == queue->count_max) {
+        GLuint count_max = queue->count_max ? queue->count_max * 2 : CHUNK_SIZE * CHUNK_SIZE;
+
+        light_node* nodes = (light_node*) SDL_realloc(queue->nodes, count_max * sizeof(light_node));
+        if(!nodes) {
+            fprintf(stderr, "[ERR] LIGHT: Could not grow the light queue | Count: %u\n", count_max);
+            job->failed = true;
+
+            return false;
+        }
+
+        queue->nodes = nodes;
+        queue->count_max = count_max;
+    }
+
+    queue->nodes[queue->count++] = (light_node) { .index = index, .level = (GLubyte) level };
+
+    return true;
+}
+
+static bool PushLightEvent(light_events* events, light_event event) {
+    if(events->count == events->count_max) {
+        GLuint count_max = events->count_max ? events->count_max * 2 : LIGHT_EVENTS_COUNT_MIN;
+
+        light_event* grown = (light_event*) SDL_realloc(events->events, count_max * sizeof(light_event));
+        if(!grown) {
+            fprintf(stderr, "[ERR] LIGHT: Could not grow the light events | Count: %u\n", count_max);
+
+            return false;
+        }
+
+        events->events = grown;
+        events->count_max = count_max;
+    }
+
+    events->events[events->count++] = event;
+
+    return true;
+}
+
+// Sends an event to the neighbour holding the padding voxel at 'position'
+static void PushLightOutgoing(chunk_light_job* job, const int position[3], light_event event) {
+    voxel_face face =
+        position[1] >= CHUNK_SIZE ? VOXEL_FACE_TOP :
+        position[1] < 0 ? VOXEL_FACE_DOWN :
+        position[2] >= CHUNK_SIZE ? VOXEL_FACE_FRONT :
+        position[2] < 0 ? VOXEL_FACE_BACK :
+        position[0] < 0 ? VOXEL_FACE_LEFT : VOXEL_FACE_RIGHT;
+
+    event.index = CHUNK_INDEX(
+        (position[0] + CHUNK_SIZE) % CHUNK_SIZE,
+        (position[1] + CHUNK_SIZE) % CHUNK_SIZE,
+        (position[2] + CHUNK_SIZE) % CHUNK_SIZE
+    );
+
+    if(!PushLightEvent(&job->outgoing[face], event)) {
+        job->failed = true;
+    }
+}
+
+// Light sources shine with their own light, whatever else reaches them
+static void AddLightSource(chunk_light_job* job, GLuint index, light_channel channel) {
+    GLuint emission = channel == LIGHT_CHANNEL_BLOCK ? GetVoxelEmission(job->voxels[index]) : 0;
+
+    if(emission > GetLightLevel(job->light, index, channel)) {
+        SetLightLevel(job->light, index, channel, emission);
+        PushLightNode(job, &job->additions, index, emission);
+    }
+}
+
+// Unlights the voxel at 'index', relighting it right away when it's a light source
+static void RemoveLight(chunk_light_job* job, GLuint index, light_channel channel) {
+    GLuint level = GetLightLevel(job->light, index, channel);
+    if(level > 0) {
+        SetLightLevel(job->light, index, channel, 0);
+        PushLightNode(job, &job->removals, index, level);
+    }
+
+    AddLightSource(job, index, channel);
+}
+
+// Raises the voxel at 'index' to 'level', if the light can get in
+static void AddLight(chunk_light_job* job, GLuint index, light_channel channel, GLuint level) {
+    if(level == 0 || IsVoxelOpaque(job->voxels[index]) || GetLightLevel(job->light, index, channel) >= level) {
+        return;
+    }
+
+    SetLightLevel(job->light, index, channel, level);
+    PushLightNode(job, &job->additions, index, level);
+}
+
+// Unlight: walks out from the unlit voxels through every voxel that got its light from them, clearing it.
+// The brighter voxels found on the edge of that area are lit by something else, and relight it afterwards.
+static void SpreadLightRemovals(chunk_light_job* job, light_channel channel) {
+    light_queue* queue = &job->removals;
+
+    for(; queue->first < queue->count; queue->first++) {
+        light_node node = queue->nodes[queue->first];
+
+        for(int face = 0; face < VOXEL_FACE_COUNT; face++) {
+            GLuint index = node.index + light_face_offsets[face];
+            GLuint level = GetLightLevel(job->light, index, channel);
+
+            int position[3];
+            GetLightPosition(index, position);
+
+            bool dependent = IsLightDependent(channel, face, node.level, level);
+
+            if(!IsLightInside(position)) {
+                if(dependent) {
+                    // Up to the neighbour to tell whether its voxel was lit from here
+                    PushLightOutgoing(job, position, (light_event) { .kind = LIGHT_EVENT_REMOVE, .channel = channel, .level = node.level, .downward = face == VOXEL_FACE_DOWN });
+                    SetLightLevel(job->light, index, channel, 0);
+                } else if(level > 0) {
+                    PushLightNode(job, &job->additions, index, level);
+                }
+            } else if(dependent) {
+                RemoveLight(job, index, channel);
+            } else if(level > 0) {
+                PushLightNode(job, &job->additions, index, level);
+            }
+        }
+    }
+
+    queue->first = 0;
+    queue->count = 0;
+}
+
+// Relight: the flood fill itself. Voxels of the padding only spread into the chunk (the steps out of the
+// padded snapshot wrap around to other padding voxels, which are skipped), the light leaving
+// the chunk becomes an event for the neighbour (and is written to the padding, so it's only sent once per level).
+static void SpreadLightAdditions(chunk_light_job* job, light_channel channel) {
+    light_queue* queue = &job->additions;
+
+    for(; queue->first < queue->count; queue->first++) {
+        light_node node = queue->nodes[queue->first];
+
+        // Unlit or raised again since it was queued, the latest push spreads it
+        GLuint level = GetLightLevel(job->light, node.index, channel);
+        if(level == 0 || level != node.level) {
+            continue;
+        }
+
+        int source[3];
+        GetLightPosition(node.index, source);
+
+        const bool inside = IsLightInside(source);
+
+        for(int face = 0; face < VOXEL_FACE_COUNT; face++) {
+            GLuint index = node.index + light_face_offsets[face];
+
+            int position[3];
+            GetLightPosition(index, position);
+
+            if(IsLightInside(position)) {
+                AddLight(job, index, channel, GetLightSpread(channel, face, level));
+
+                continue;
+            }
+
+            if(!inside) {
+                continue;
+            }
+
+            GLuint spread = GetLightSpread(channel, face, level);
+            if(spread == 0 || IsVoxelOpaque(job->voxels[index]) || GetLightLevel(job->light, index, channel) >= spread) {
+                continue;
+            }
+
+            SetLightLevel(job->light, index, channel, spread);
+            PushLightOutgoing(job, position, (light_event) { .kind = LIGHT_EVENT_ADD, .channel = channel, .level = spread });
+        }
+    }
+
+    queue->first = 0;
+    queue->count = 0;
+}
+
+// Every voxel of the chunk unlit, then lit again from the light sources, the sky and the neighbours
+static void QueueLightReset(chunk_light_job* job, light_channel channel) {
+    for(int y = -1; y <= CHUNK_SIZE; y++) {
+        for(int z = -1; z <= CHUNK_SIZE; z++) {
+            for(int x = -1; x <= CHUNK_SIZE; x++) {
+                GLuint index = CHUNK_PADDED_INDEX(x, y, z);
+
+                if(!IsLightInside((int[3]) { x, y, z })) {
+                    GLuint level = GetLightLevel(job->light, index, channel);
+                    if(level > 0) {
+                        PushLightNode(job, &job->additions, index, level);
+                    }
+                } else {
+                    RemoveLight(job, index, channel); // Also seeds the light sources
+                }
+            }
+        }
+    }
+}
+
+static void QueueLightEvent(chunk_light_job* job, light_event event, light_channel channel) {
+    const int position[3] = {
+        event.index % CHUNK_SIZE,
+        event.index / (CHUNK_SIZE * CHUNK_SIZE),
+        event.index / CHUNK_SIZE % CHUNK_SIZE
+    };
+
+    const GLuint index = CHUNK_PADDED_INDEX(position[0], position[1], position[2]);
+
+    switch(event.kind) {
+        case LIGHT_EVENT_VOXEL: {
+            // Transparent voxels keep their sunlight, only a removed light source takes its block light away
+            if(IsVoxelOpaque(job->voxels[index]) || channel == LIGHT_CHANNEL_BLOCK) {
+                RemoveLight(job, index, channel);
+            }
+
+            AddLightSource(job, index, channel);
+
+            // An opened voxel is lit again from around it
+            if(!IsVoxelOpaque(job->voxels[index])) {
+                for(int face = 0; face < VOXEL_FACE_COUNT; face++) {
+                    GLuint neighbour = index + light_face_offsets[face];
+                    GLuint level = GetLightLevel(job->light, neighbour, channel);
+
+                    if(level > 0) {
+                        PushLightNode(job, &job->additions, neighbour, level);
+                    }
+                }
+            }
+        } break;
+
+        case LIGHT_EVENT_ADD: {
+            if(event.channel == channel) {
+                AddLight(job, index, channel, event.level);
+            }
+        } break;
+
+        case LIGHT_EVENT_REMOVE: {
+            if(event.channel != channel) {
+                break;
+            }
+
+            GLuint level = GetLightLevel(job->light, index, channel);
+
+            // Only the direction down matters to IsLightDependent
+            if(IsLightDependent(channel, event.downward ? VOXEL_FACE_DOWN : VOXEL_FACE_TOP, event.level, level)) {
+                RemoveLight(job, index, channel);
+            } else if(level > 0) {
+                // Lit by something else, which lights the removed voxel again
+                PushLightNode(job, &job->additions, index, level);
+            }
+        } break;
+    }
+}
+
+// Runs on a worker thread: only touches the job's own snapshots
+static void ChunkLightJob(void* data) {
+    chunk_light_job* job = (chunk_light_job*) data;
+
+    if(job->sky) {
+        for(int z = -1; z <= CHUNK_SIZE; z++) {
+            for(int x = -1; x <= CHUNK_SIZE; x++) {
+                SetLightLevel(job->light, CHUNK_PADDED_INDEX(x, CHUNK_SIZE, z), LIGHT_CHANNEL_SUN, LIGHT_LEVEL_MAX);
+            }
+        }
+    }
+
+    SDL_memcpy(job->light_before, job->light, CHUNK_PADDED_VOLUME);
+
+    for(light_channel channel = LIGHT_CHANNEL_SUN; channel <= LIGHT_CHANNEL_BLOCK; channel++) {
+        if(job->reset) {
+            QueueLightReset(job, channel);
+        } else {
+            for(GLuint event = 0; event < job->events_count; event++) {
+                QueueLightEvent(job, job->events[event], channel);
+            }
+        }
+
+        SpreadLightRemovals(job, channel);
+        SpreadLightAdditions(job, channel);
+    }
+
+    SDL_free(job->removals.nodes);
+    SDL_free(job->additions.nodes);
+    job->removals = (light_queue) { 0 };
+    job->additions = (light_queue) { 0 };
+
+    for(int y = 0; y < CHUNK_SIZE; y++) {
+        for(int z = 0; z < CHUNK_SIZE; z++) {
+            const GLubyte* row = &job->light[CHUNK_PADDED_INDEX(0, y, z)];
+
+            if(SDL_memcmp(row, &job->light_before[CHUNK_PADDED_INDEX(0, y, z)], CHUNK_SIZE) == 0) {
+                continue;
+            }
+
+            job->changed = true;
+
+            const bool border[VOXEL_FACE_COUNT] = {
+                y == CHUNK_SIZE - 1, y == 0,
+                z == CHUNK_SIZE - 1, z == 0,
+                row[0] != job->light_before[CHUNK_PADDED_INDEX(0, y, z)],
+                row[CHUNK_SIZE - 1] != job->light_before[CHUNK_PADDED_INDEX(CHUNK_SIZE - 1, y, z)]
+            };
+
+            for(int face = 0; face < VOXEL_FACE_COUNT; face++) {
+                if(border[face]) {
+                    job->borders |= 1u << face;
+                }
+            }
+        }
+    }
+
+    if(!job->changed) {
+        return;
+    }
+
+    for(int y = 0; y < CHUNK_SIZE; y++) {
+        for(int z = 0; z < CHUNK_SIZE; z++) {
+            SDL_memcpy(&job->result[CHUNK_INDEX(0, y, z)], &job->light[CHUNK_PADDED_INDEX(0, y, z)], CHUNK_SIZE);
+        }
+    }
+
+    LoadChunkStorage(&job->storage, CHUNK_VOLUME, 0);
+
+    if(!EncodeChunkStorage(&job->storage, job->result)) {
+        job->changed = false;
+        job->failed = true;
+    }
+}
+
+static void FreeChunkLightJob(chunk_light_job* job) {
+    for(int face = 0; face < VOXEL_FACE_COUNT; face++) {
+        SDL_free(job->outgoing[face].events);
+    }
+
+    UnloadChunkStorage(&job->storage);
+    SDL_free(job->events);
+    SDL_free(job);
+}
+
+// Runs on the main thread: stores the light and hands the light crossing the borders over to the neighbours
+static void ChunkLightJobComplete(void* data) {
+    chunk_light_job* job = (chunk_light_job*) data;
+    chunk* chunk = job->chunk;
+
+    if(!chunk) {
+        FreeChunkLightJob(job);
+
+        return;
+    }
+
+    chunk->light_job = NULL;
+
+    if(job->changed) {
+        UnloadChunkStorage(&chunk->light);
+        chunk->light = job->storage;
+        job->storage = (chunk_storage) { 0 };
+
+        chunk->dirty = true;
+
+        // The neighbours light their faces on the border from these voxels
+        for(int face = 0; face < VOXEL_FACE_COUNT; face++) {
+            if((job->borders & (1u << face)) && chunk->neighbours[face]) {
+                chunk->neighbours[face]->dirty = true;
+            }
+        }
+    }
+
+    if(job->failed) {
+        QueueChunkLightReset(chunk);
+    }
+
+    // Light leaving towards a chunk that isn't loaded is picked up from this chunk's border once it is
+    for(int face = 0; face < VOXEL_FACE_COUNT; face++) {
+        struct chunk* neighbour = chunk->neighbours[face];
+
+        for(GLuint event = 0; neighbour && event < job->outgoing[face].count; event++) {
+            QueueChunkLightEvent(neighbour, job->outgoing[face].events[event]);
+        }
+    }
+
+    FreeChunkLightJob(job);
+}
+
+// Takes the pending events and snapshots of the chunk
+static chunk_light_job* LoadChunkLightJob(chunk* chunk, bool sky) {
+    chunk_light_job* job = (chunk_light_job*) SDL_calloc(1, sizeof(chunk_light_job));
+    if(!job) {
+        fprintf(stderr, "[ERR] LIGHT: Could not allocate a light job\n");
+
+        return NULL;
+    }
+
+    job->chunk = chunk;
+    job->sky = sky;
+    job->reset = chunk->light_reset;
+    job->events = chunk->light_events;
+    job->events_count = chunk->light_events_count;
+
+    chunk->light_reset = false;
+    chunk->light_events = NULL;
+    chunk->light_events_count = 0;
+    chunk->light_events_count_max = 0;
+
+    CopyChunkVoxels(chunk, job->voxels);
+    CopyChunkLight(chunk, job->light);
+
+    return job;
+}
+
+void QueueChunkLightEvent(chunk* chunk, light_event event) {
+    // Everything is relit anyway
+    if(chunk->light_reset) {
+        return;
+    }
+
+    light_events events = { chunk->light_events, chunk->light_events_count, chunk->light_events_count_max };
+
+    if(!PushLightEvent(&events, event)) {
+        QueueChunkLightReset(chunk);
+
+        return;
+    }
+
+    chunk->light_events = events.events;
+    chunk->light_events_count = events.count;
+    chunk->light_events_count_max = events.count_max;
+}
+
+void QueueChunkLightReset(chunk* chunk) {
+    chunk->light_reset = true;
+    chunk->light_events_count = 0;
+}
+
+void ClearChunkLight(chunk* chunk) {
+    if(chunk->light_job) {
+        chunk->light_job->chunk = NULL;
+        chunk->light_job = NULL;
+    }
+
+    SDL_free(chunk->light_events);
+    chunk->light_events = NULL;
+    chunk->light_events_count = 0;
+    chunk->light_events_count_max = 0;
+}
+
+bool IsChunkLightPending(chunk* chunk) {
+    return chunk->light_reset || chunk->light_events_count > 0;
+}
+
+bool CanChunkLight(chunk* chunk) {
+    if(chunk->light_job) {
+        return false;
+    }
+
+    // Their jobs write the light this one reads from the borders, and the other way around
+    for(int face = 0; face < VOXEL_FACE_COUNT; face++) {
+        if(chunk->neighbours[face] && chunk->neighbours[face]->light_job) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void LightChunk(chunk* chunk, bool sky) {
+    chunk_light_job* light_job = LoadChunkLightJob(chunk, sky);
+    if(!light_job) {
+        return;
+    }
+
+    ChunkLightJob(light_job);
+    ChunkLightJobComplete(light_job);
+}
+
+bool ScheduleChunkLight(chunk* chunk, bool sky) {
+    if(!CanChunkLight(chunk)) {
+        return false;
+    }
+
+    bool reset = chunk->light_reset;
+    GLuint events_count_max = chunk->light_events_count_max;
+
+    chunk_light_job* light_job = LoadChunkLightJob(chunk, sky);
+    if(!light_job) {
+        return false;
+    }
+
+    if(!PushJob((job) { .function = ChunkLightJob, .complete = ChunkLightJobComplete, .data = light_job })) {
+        // The job queue is full, the events wait for the next try
+        chunk->light_reset = reset;
+        chunk->light_events = light_job->events;
+        chunk->light_events_count = light_job->events_count;
+        chunk->light_events_count_max = events_count_max;
+
+        light_job->events = NULL;
+        FreeChunkLightJob(light_job);
+
+        return false;
+    }
+
+    chunk->light_job = light_job;
+
+    return true;
+}
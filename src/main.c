@@ -9,15 +9,21 @@
 #include "render_batch.h"
 #include "shader.h"
 #include "voxel.h"
+#include "chunk.h"
+#include "chunk_arena.h"
+#include "job.h"
+#include "region.h"
+#include "terrain.h"
+#include "world.h"
 
 #include <GL/gl.h>  
 
-#define VOXEL_SIZE 16.0f
-
 int main(int argc, const char* argv[]) {
     CreateWindow((ivec2) { 640, 640 }, "Voxel Engine 1.0");
 
-    camera camera = CameraInit(CAMERA_PERSPECTIVE, (vec3) { 0.0f, 0.0f, 0.0f }, 90.0f);
+    LoadJobSystem(0);
+
+    camera camera = CameraInit(CAMERA_PERSPECTIVE, (vec3) { 0.0f, 96.0f * VOXEL_SIZE, 0.0f }, 90.0f);
 
     // Creating the basic shaders
 
@@ -25,26 +31,46 @@ int main(int argc, const char* argv[]) {
     *GetDefaultShader(GL_FRAGMENT_SHADER) = CreateShader("../res/shaders/fragment.glsl", GL_FRAGMENT_SHADER);
     *GetDefaultProgram() = CreateProgram(*GetDefaultShader(GL_VERTEX_SHADER), *GetDefaultShader(GL_FRAGMENT_SHADER));
 
+    LoadChunkProgram("../res/shaders/chunk_vertex.glsl", "../res/shaders/fragment.glsl");
+    LoadChunkArena(1 << 20, 3 << 19);
+
     // Render-batch
 
-    LoadRenderBatch(1024);
+    LoadRenderBatch(1024, RENDER_BATCH_FLUSH);
+
+    // Terrain
+
+    terrain_settings terrain = GetDefaultTerrainSettings(1337);
+
+    region_store regions;
+    bool regions_loaded = LoadRegionStore(&regions, "../saves"); // Without it the world is only generated, never saved
+
+    world_settings world_settings = GetDefaultWorldSettings(GenerateTerrain, &terrain);
+    world_settings.regions = regions_loaded ? &regions : NULL;
+
+    world world;
+    LoadWorld(&world, world_settings);
 
     while(!WindowCloseCallback()) {  
         CameraMovement(&camera, true);   
+        UpdateWorld(&world, &camera);
 
         BeginRenderMode(&camera);
         Clear((vec4) { 0.1f, 0.1f, 0.1, 1.0f });
 
-        RenderVoxel((vec3) { 0.0f * VOXEL_SIZE, 0.0f, 0.0f * VOXEL_SIZE }, VOXEL_SIZE, (vec4) { 1.0f, 1.0f, 1.0f, 1.0f }, true, true, false, true, true, false);
-        RenderVoxel((vec3) { 0.0f * VOXEL_SIZE, 0.0f, 1.0f * VOXEL_SIZE }, VOXEL_SIZE, (vec4) { 1.0f, 1.0f, 1.0f, 1.0f }, true, true, true, false, true, false);
-        RenderVoxel((vec3) { 1.0f * VOXEL_SIZE, 0.0f, 0.0f * VOXEL_SIZE }, VOXEL_SIZE, (vec4) { 1.0f, 1.0f, 1.0f, 1.0f }, true, true, false, true, false, true);
-        RenderVoxel((vec3) { 1.0f * VOXEL_SIZE, 0.0f, 1.0f * VOXEL_SIZE }, VOXEL_SIZE, (vec4) { 1.0f, 1.0f, 1.0f, 1.0f }, true, true, true, false, false, true);
+        RenderWorld(&world);
 
         EndRenderMode();
     }
 
+    UnloadWorld(&world); // Queues the edited chunks still loaded
+    UnloadRegionStore(&regions); // Waits for them to be on the disk
+    UnloadJobSystem();
+
     UnloadRenderBatch();
-    DeleteProgram(*GetDefaultProgram());
+    UnloadChunkArena();
+    UnloadChunkProgram();
+    DeleteProgram(GetDefaultProgram());
 
     CloseWindow();
 
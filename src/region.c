@@ -0,0 +1,699 @@
+#include "region.h"
+
+#include <stdio.h>
+
+#include "SDL2/SDL.h"
+
+#if defined (_WIN32)
+    #include <direct.h>
+    #include <io.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#define REGION_PAYLOAD_MAX (1 + CHUNK_VOLUME * 3) // Codec byte, then one run per voxel in the worst case
+
+static int GetRegionCoordinate(int chunk, int size) {
+    return chunk >= 0 ? chunk / size : -((-chunk + size - 1) / size);
+}
+
+static GLuint GetRegionChunkIndex(const int position[3]) {
+    int x = position[0] - GetRegionCoordinate(position[0], REGION_SIZE) * REGION_SIZE;
+    int y = position[1] - GetRegionCoordinate(position[1], REGION_HEIGHT) * REGION_HEIGHT;
+    int z = position[2] - GetRegionCoordinate(position[2], REGION_SIZE) * REGION_SIZE;
+
+    return x + z * REGION_SIZE + y * REGION_SIZE * REGION_SIZE;
+}
+
+static GLuint GetRegionSectors(GLuint size) {
+    return (size + REGION_SECTOR_SIZE - 1) / REGION_SECTOR_SIZE;
+}
+
+static void UnmapRegion(region* region) {
+    if(!region->mapping) {
+        return;
+    }
+
+#if defined (_WIN32)
+    SDL_free((void*) region->mapping);
+#else
+    munmap((void*) region->mapping, region->mapping_size);
+#endif
+
+    region->mapping = NULL;
+    region->mapping_size = 0;
+}
+
+// Without mmap the whole file is read instead, which costs more up front but reads the same afterwards
+static bool MapRegion(region_store* store, region* region) {
+    if(region->mapping) {
+        return true;
+    }
+
+    // Writes may still sit in the stdio buffer
+    if(region->file) {
+        fflush(region->file);
+    }
+
+#if defined (_WIN32)
+    size_t size = 0;
+    void* mapping = SDL_LoadFile(region->path, &size);
+    if(!mapping) {
+        return false;
+    }
+#else
+    int descriptor = open(region->path, O_RDONLY);
+    if(descriptor < 0) {
+        return false;
+    }
+
+    struct stat status;
+    if(fstat(descriptor, &status) != 0 || status.st_size == 0) {
+        close(descriptor);
+
+        return false;
+    }
+
+    size_t size = (size_t) status.st_size;
+    void* mapping = mmap(NULL, size, PROT_READ, MAP_SHARED, descriptor, 0);
+    close(descriptor); // The mapping keeps the file referenced
+
+    if(mapping == MAP_FAILED) {
+        fprintf(stderr, "[ERR] REGION: Could not map a region | Path: %s\n", region->path);
+
+        return false;
+    }
+#endif
+
+    region->mapping = (const GLubyte*) mapping;
+    region->mapping_size = size;
+    store->stats.mappings++;
+
+    return true;
+}
+
+static void SyncRegionFile(FILE* file) {
+    fflush(file);
+
+#if defined (_WIN32)
+    _commit(_fileno(file));
+#else
+    fsync(fileno(file));
+#endif
+}
+
+static void CloseRegion(region* region) {
+    UnmapRegion(region);
+
+    if(region->file) {
+        fclose(region->file);
+    }
+
+    region->used = false;
+    region->file = NULL;
+}
+
+// Eviction can happen on the main thread, so the file is only flushed here.
+// Syncing and closing it is left to the writer thread, or to FlushRegionStore, with 'regions_lock' held.
+static void EvictRegion(region_store* store, region* region) {
+    if(region->file) {
+        fflush(region->file);
+
+        if(store->evicted_count == store->evicted_count_max) {
+            GLuint count_max = SDL_max(store->evicted_count_max * 2, REGION_CACHE_SIZE);
+
+            FILE** evicted = (FILE**) SDL_realloc(store->evicted, count_max * sizeof(FILE*));
+            if(evicted) {
+                store->evicted = evicted;
+                store->evicted_count_max = count_max;
+            }
+        }
+
+        // Without room for it, the file is closed without the sync
+        if(store->evicted_count < store->evicted_count_max) {
+            store->evicted[store->evicted_count++] = region->file;
+            region->file = NULL;
+        }
+    }
+
+    CloseRegion(region);
+}
+
+// Syncs and closes the files of the evicted regions, one at a time so reads aren't held up by the disk
+static void SyncEvictedRegions(region_store* store) {
+    for(;;) {
+        SDL_LockMutex(store->regions_lock);
+        FILE* file = store->evicted_count > 0 ? store->evicted[--store->evicted_count] : NULL;
+        SDL_UnlockMutex(store->regions_lock);
+
+        if(!file) {
+            break;
+        }
+
+        SyncRegionFile(file);
+        fclose(file);
+    }
+}
+
+// Region of the chunk from the cache, opening it (and evicting the least recently used one) when needed.
+// NULL when its path doesn't fit in REGION_PATH_MAX.
+static region* GetRegion(region_store* store, const int chunk_position[3]) {
+    int position[3] = {
+        GetRegionCoordinate(chunk_position[0], REGION_SIZE),
+        GetRegionCoordinate(chunk_position[1], REGION_HEIGHT),
+        GetRegionCoordinate(chunk_position[2], REGION_SIZE)
+    };
+
+    region* result = NULL;
+
+    for(GLuint index = 0; index < REGION_CACHE_SIZE; index++) {
+        region* candidate = &store->regions[index];
+
+        if(candidate->used && candidate->position[0] == position[0] && candidate->position[1] == position[1] && candidate->position[2] == position[2]) {
+            candidate->last_used = ++store->clock;
+
+            return candidate;
+        }
+
+        if(!result || !candidate->used || (result->used && candidate->last_used < result->last_used)) {
+            result = candidate;
+        }
+    }
+
+    if(result->used) {
+        EvictRegion(store, result);
+    }
+
+    SDL_memset(result, 0, sizeof(region));
+
+    if(!GetRegionPath(store->directory, position, result->path)) {
+        fprintf(stderr, "[ERR] REGION: Region path too long | Directory: %s\n", store->directory);
+
+        return NULL;
+    }
+
+    result->used = true;
+    result->position[0] = position[0];
+    result->position[1] = position[1];
+    result->position[2] = position[2];
+    result->last_used = ++store->clock;
+
+    store->stats.regions_opened++;
+
+    // A missing file is a region with nothing stored yet
+    if(!MapRegion(store, result)) {
+        return result;
+    }
+
+    const region_header* header = (const region_header*) result->mapping;
+
+    if(result->mapping_size < sizeof(region_header) || SDL_SwapLE32(header->magic) != REGION_MAGIC || SDL_SwapLE32(header->version) != REGION_VERSION) {
+        fprintf(stderr, "[WARN] REGION: Ignoring an invalid region file | Path: %s\n", result->path);
+        UnmapRegion(result);
+
+        return result;
+    }
+
+    for(GLuint index = 0; index < REGION_CHUNKS; index++) {
+        result->entries[index].offset = SDL_SwapLE32(header->entries[index].offset);
+        result->entries[index].size = SDL_SwapLE32(header->entries[index].size);
+    }
+
+    result->exists = true;
+    result->file_size = result->mapping_size;
+
+    return result;
+}
+
+// Opens the file for writing, writing an empty header first if the region is new
+static bool OpenRegionFile(region* region) {
+    if(region->file) {
+        return true;
+    }
+
+    region->file = fopen(region->path, region->exists ? "r+b" : "w+b");
+    if(!region->file) {
+        fprintf(stderr, "[ERR] REGION: Could not open a region for writing | Path: %s\n", region->path);
+
+        return false;
+    }
+
+    if(!region->exists) {
+        region_header header = { 0 };
+        header.magic = SDL_SwapLE32(REGION_MAGIC);
+        header.version = SDL_SwapLE32(REGION_VERSION);
+
+        if(fwrite(&header, sizeof(region_header), 1, region->file) != 1) {
+            fprintf(stderr, "[ERR] REGION: Could not write a region header | Path: %s\n", region->path);
+
+            // A file without its header can't be read back, the next save starts it over
+            fclose(region->file);
+            region->file = NULL;
+            remove(region->path);
+
+            return false;
+        }
+
+        SDL_memset(region->entries, 0, sizeof(region->entries));
+        region->file_size = GetRegionSectors(sizeof(region_header)) * REGION_SECTOR_SIZE;
+        region->exists = true;
+    }
+
+    return true;
+}
+
+static GLuint CompressRegionChunk(const GLubyte* voxels, GLubyte* payload) {
+    GLuint size = 0;
+    payload[size++] = REGION_CODEC_RLE;
+
+    for(GLuint index = 0; index < CHUNK_VOLUME; ) {
+        GLubyte type = voxels[index];
+        GLuint count = 1;
+
+        while(index + count < CHUNK_VOLUME && count < 0xFFFF && voxels[index + count] == type) {
+            count++;
+        }
+
+        payload[size++] = count & 0xFF;
+        payload[size++] = count >> 8;
+        payload[size++] = type;
+
+        index += count;
+    }
+
+    return size;
+}
+
+// Returns the number of runs, 0 if the payload is damaged
+static GLuint DecompressRegionChunk(const GLubyte* payload, GLuint size, GLubyte* voxels) {
+    if(size < 1 || payload[0] != REGION_CODEC_RLE || (size - 1) % 3 != 0) {
+        return 0;
+    }
+
+    GLuint count_total = 0;
+    GLuint runs = 0;
+
+    for(GLuint offset = 1; offset < size; offset += 3) {
+        GLuint count = payload[offset] | (payload[offset + 1] << 8);
+
+        if(count == 0 || count_total + count > CHUNK_VOLUME) {
+            return 0;
+        }
+
+        SDL_memset(&voxels[count_total], payload[offset + 2], count);
+        count_total += count;
+        runs++;
+    }
+
+    return count_total == CHUNK_VOLUME ? runs : 0;
+}
+
+// Writes a compressed chunk into its region, with 'regions_lock' held
+static bool WriteRegionPayload(region_store* store, const int position[3], const GLubyte* payload, GLuint size) {
+    region* region = GetRegion(store, position);
+    if(!region || !OpenRegionFile(region)) {
+        return false;
+    }
+
+    // Rewritten in place when it still fits in its sectors, appended otherwise (the old sectors are left unused)
+    GLuint index = GetRegionChunkIndex(position);
+    region_entry entry = region->entries[index];
+
+    if(entry.offset == 0 || GetRegionSectors(size) > GetRegionSectors(entry.size)) {
+        entry.offset = (GLuint) region->file_size;
+        region->file_size += GetRegionSectors(size) * REGION_SECTOR_SIZE;
+    }
+
+    entry.size = size;
+
+    region_entry entry_disk = { SDL_SwapLE32(entry.offset), SDL_SwapLE32(entry.size) };
+    long entry_offset = (long) (offsetof(region_header, entries) + index * sizeof(region_entry));
+
+    // Sectors are padded to their full size, so the file always ends on a sector boundary
+    static const GLubyte padding[REGION_SECTOR_SIZE] = { 0 };
+    GLuint padding_size = GetRegionSectors(size) * REGION_SECTOR_SIZE - size;
+
+    bool written =
+        fseek(region->file, (long) entry.offset, SEEK_SET) == 0 &&
+        fwrite(payload, 1, size, region->file) == size &&
+        fwrite(padding, 1, padding_size, region->file) == padding_size &&
+        fseek(region->file, entry_offset, SEEK_SET) == 0 &&
+        fwrite(&entry_disk, sizeof(region_entry), 1, region->file) == 1;
+
+    if(!written) {
+        fprintf(stderr, "[ERR] REGION: Could not write a chunk | Path: %s\n", region->path);
+
+        return false;
+    }
+
+    region->entries[index] = entry;
+
+    // The file may have grown past the mapping
+    UnmapRegion(region);
+
+    store->stats.chunks_written++;
+    store->stats.bytes_written += size;
+
+    return true;
+}
+
+// Newest queued save of the chunk at 'position', looking at the saves from 'first' on, with 'saves_lock' held
+static region_save* FindRegionSave(region_store* store, const int position[3], GLuint first) {
+    for(GLuint index = store->saves_count; index > first; index--) {
+        region_save* save = store->saves[index - 1];
+
+        if(save->position[0] == position[0] && save->position[1] == position[1] && save->position[2] == position[2]) {
+            return save;
+        }
+    }
+
+    return NULL;
+}
+
+static int RegionWriter(void* data) {
+    region_store* store = (region_store*) data;
+
+    SDL_LockMutex(store->saves_lock);
+
+    for(;;) {
+        while(store->saves_count == 0 && !store->quit) {
+            SDL_CondWait(store->saves_queued, store->saves_lock);
+        }
+
+        if(store->saves_count == 0) {
+            break;
+        }
+
+        // Everything queued so far is one batch, saves queued meanwhile wait for the next one.
+        // The batch is never changed by the main thread, only read, so it's compressed and written unlocked.
+        GLuint batch = store->saves_count;
+        store->saves_writing = batch;
+
+        for(GLuint index = 0; index < batch; index++) {
+            region_save* save = store->saves[index];
+            SDL_UnlockMutex(store->saves_lock);
+
+            DecodeChunkStorage(&save->voxels, 0, CHUNK_VOLUME, store->write_voxels);
+            GLuint size = CompressRegionChunk(store->write_voxels, store->write_payload);
+
+            SDL_LockMutex(store->regions_lock);
+            WriteRegionPayload(store, save->position, store->write_payload, size);
+            SDL_UnlockMutex(store->regions_lock);
+
+            SDL_LockMutex(store->saves_lock);
+        }
+
+        // Hands the batch to the OS, so it doesn't wait in the stdio buffers for the next one
+        SDL_UnlockMutex(store->saves_lock);
+        SDL_LockMutex(store->regions_lock);
+
+        for(GLuint index = 0; index < REGION_CACHE_SIZE; index++) {
+            if(store->regions[index].used && store->regions[index].file) {
+                fflush(store->regions[index].file);
+            }
+        }
+
+        SDL_UnlockMutex(store->regions_lock);
+
+        // Before the batch counts as written, so FlushRegionStore can't return with an evicted file still unsynced
+        SyncEvictedRegions(store);
+
+        SDL_LockMutex(store->saves_lock);
+
+        for(GLuint index = 0; index < batch; index++) {
+            UnloadChunkStorage(&store->saves[index]->voxels);
+            SDL_free(store->saves[index]);
+        }
+
+        SDL_memmove(store->saves, &store->saves[batch], (store->saves_count - batch) * sizeof(region_save*));
+        store->saves_count -= batch;
+        store->saves_writing = 0;
+        store->stats.batches_written++;
+
+        SDL_CondBroadcast(store->saves_written);
+    }
+
+    SDL_UnlockMutex(store->saves_lock);
+
+    return 0;
+}
+
+// A single run is a uniform chunk, which needs no encoding
+static void SetRegionChunkVoxels(chunk* chunk, const GLubyte* voxels, bool uniform) {
+    if(uniform) {
+        FillChunk(chunk, voxels[0]);
+    } else {
+        SetChunkVoxels(chunk, voxels);
+    }
+
+    chunk->modified = false;
+}
+
+bool LoadRegionStore(region_store* store, const char* directory) {
+    SDL_memset(store, 0, sizeof(region_store));
+
+    // Leaves room for the file names, so no region path gets cut off
+    if(SDL_strlen(directory) > REGION_DIRECTORY_MAX) {
+        fprintf(stderr, "[ERR] REGION: Region directory path too long | Directory: %s | Max: %d\n", directory, REGION_DIRECTORY_MAX);
+
+        return false;
+    }
+
+    SDL_strlcpy(store->directory, directory, REGION_PATH_MAX);
+
+#if defined (_WIN32)
+    _mkdir(directory);
+#else
+    mkdir(directory, 0755);
+#endif
+
+    store->regions = (region*) SDL_calloc(REGION_CACHE_SIZE, sizeof(region));
+    store->voxels = (GLubyte*) SDL_malloc(CHUNK_VOLUME);
+    store->write_voxels = (GLubyte*) SDL_malloc(CHUNK_VOLUME);
+    store->write_payload = (GLubyte*) SDL_malloc(REGION_PAYLOAD_MAX);
+
+    if(!store->regions || !store->voxels || !store->write_voxels || !store->write_payload) {
+        fprintf(stderr, "[ERR] REGION: Could not allocate the region store\n");
+        UnloadRegionStore(store);
+
+        return false;
+    }
+
+    store->saves_lock = SDL_CreateMutex();
+    store->regions_lock = SDL_CreateMutex();
+    store->saves_queued = SDL_CreateCond();
+    store->saves_written = SDL_CreateCond();
+
+    if(store->saves_lock && store->regions_lock && store->saves_queued && store->saves_written) {
+        store->writer = SDL_CreateThread(RegionWriter, "RegionWriter", store);
+    }
+
+    if(!store->writer) {
+        fprintf(stderr, "[ERR] REGION: %s\n", SDL_GetError());
+        UnloadRegionStore(store);
+
+        return false;
+    }
+
+    printf("[INFO] REGION: Region store opened | Directory: %s\n", directory);
+
+    return true;
+}
+
+void UnloadRegionStore(region_store* store) {
+    if(store->writer) {
+        FlushRegionStore(store);
+
+        SDL_LockMutex(store->saves_lock);
+        store->quit = true;
+        SDL_CondSignal(store->saves_queued);
+        SDL_UnlockMutex(store->saves_lock);
+
+        SDL_WaitThread(store->writer, NULL);
+    }
+
+    if(store->regions) {
+        for(GLuint index = 0; index < REGION_CACHE_SIZE; index++) {
+            if(store->regions[index].used) {
+                CloseRegion(&store->regions[index]);
+            }
+        }
+    }
+
+    if(store->saves_lock) SDL_DestroyMutex(store->saves_lock);
+    if(store->regions_lock) SDL_DestroyMutex(store->regions_lock);
+    if(store->saves_queued) SDL_DestroyCond(store->saves_queued);
+    if(store->saves_written) SDL_DestroyCond(store->saves_written);
+
+    SDL_free(store->saves);
+    SDL_free(store->evicted);
+    SDL_free(store->regions);
+    SDL_free(store->voxels);
+    SDL_free(store->write_voxels);
+    SDL_free(store->write_payload);
+
+    SDL_memset(store, 0, sizeof(region_store));
+}
+
+bool ReadRegionChunk(region_store* store, chunk* chunk) {
+    const int position[3] = { chunk->position[0], chunk->position[1], chunk->position[2] };
+
+    // A save still in the queue is newer than what's on the disk
+    SDL_LockMutex(store->saves_lock);
+
+    region_save* save = FindRegionSave(store, position, 0);
+    bool uniform = save && save->voxels.bits == 0;
+
+    if(save) {
+        DecodeChunkStorage(&save->voxels, 0, CHUNK_VOLUME, store->voxels);
+        store->stats.chunks_read_queued++;
+    }
+
+    SDL_UnlockMutex(store->saves_lock);
+
+    if(save) {
+        SetRegionChunkVoxels(chunk, store->voxels, uniform);
+
+        return true;
+    }
+
+    SDL_LockMutex(store->regions_lock);
+
+    region* region = GetRegion(store, position);
+    if(!region) {
+        SDL_UnlockMutex(store->regions_lock);
+
+        return false;
+    }
+
+    region_entry entry = region->entries[GetRegionChunkIndex(position)];
+    GLuint runs = 0;
+
+    if(!region->exists || entry.offset == 0) {
+        store->stats.chunks_missing++;
+    } else if(!MapRegion(store, region) || (size_t) entry.offset + entry.size > region->mapping_size) {
+        fprintf(stderr, "[ERR] REGION: Chunk outside of its region | Path: %s | Offset: %u\n", region->path, entry.offset);
+    } else if((runs = DecompressRegionChunk(region->mapping + entry.offset, entry.size, store->voxels)) == 0) {
+        fprintf(stderr, "[ERR] REGION: Damaged chunk payload | Path: %s | Offset: %u\n", region->path, entry.offset);
+    } else {
+        store->stats.chunks_read++;
+        store->stats.bytes_read += entry.size;
+    }
+
+    SDL_UnlockMutex(store->regions_lock);
+
+    if(runs == 0) {
+        return false;
+    }
+
+    SetRegionChunkVoxels(chunk, store->voxels, runs == 1);
+
+    return true;
+}
+
+bool QueueRegionChunk(region_store* store, chunk* chunk) {
+    const int position[3] = { chunk->position[0], chunk->position[1], chunk->position[2] };
+
+    // Copied before locking, the palette-compressed voxels are small and quick to copy
+    chunk_storage voxels;
+    if(!CopyChunkStorage(&voxels, &chunk->voxels)) {
+        return false;
+    }
+
+    SDL_LockMutex(store->saves_lock);
+
+    // Saves in the batch being written can't be changed anymore
+    region_save* save = FindRegionSave(store, position, store->saves_writing);
+
+    if(save) {
+        UnloadChunkStorage(&save->voxels);
+        save->voxels = voxels;
+
+        store->stats.chunks_coalesced++;
+    } else {
+        if(store->saves_count == store->saves_count_max) {
+            GLuint count_max = SDL_max(store->saves_count_max * 2, 64);
+
+            region_save** saves = (region_save**) SDL_realloc(store->saves, count_max * sizeof(region_save*));
+            if(!saves) {
+                SDL_UnlockMutex(store->saves_lock);
+                UnloadChunkStorage(&voxels);
+
+                return false;
+            }
+
+            store->saves = saves;
+            store->saves_count_max = count_max;
+        }
+
+        save = (region_save*) SDL_malloc(sizeof(region_save));
+        if(!save) {
+            SDL_UnlockMutex(store->saves_lock);
+            UnloadChunkStorage(&voxels);
+
+            return false;
+        }
+
+        save->position[0] = position[0];
+        save->position[1] = position[1];
+        save->position[2] = position[2];
+        save->voxels = voxels;
+
+        store->saves[store->saves_count++] = save;
+        SDL_CondSignal(store->saves_queued);
+    }
+
+    store->stats.chunks_queued++;
+
+    SDL_UnlockMutex(store->saves_lock);
+
+    chunk->modified = false;
+
+    return true;
+}
+
+void FlushRegionStore(region_store* store) {
+    SDL_LockMutex(store->saves_lock);
+
+    while(store->saves_count > 0) {
+        SDL_CondWait(store->saves_written, store->saves_lock);
+    }
+
+    SDL_UnlockMutex(store->saves_lock);
+
+    // Everything is written to the files, now make sure it's on the disk too
+    SyncEvictedRegions(store);
+
+    SDL_LockMutex(store->regions_lock);
+
+    for(GLuint index = 0; index < REGION_CACHE_SIZE; index++) {
+        region* region = &store->regions[index];
+
+        if(region->used && region->file) {
+            SyncRegionFile(region->file);
+        }
+    }
+
+    SDL_UnlockMutex(store->regions_lock);
+}
+
+region_stats GetRegionStoreStats(region_store* store) {
+    SDL_LockMutex(store->saves_lock);
+    SDL_LockMutex(store->regions_lock);
+
+    region_stats stats = store->stats;
+
+    SDL_UnlockMutex(store->regions_lock);
+    SDL_UnlockMutex(store->saves_lock);
+
+    return stats;
+}
+
+bool GetRegionPath(const char* directory, const int position[3], char* path) {
+    int length = SDL_snprintf(path, REGION_PATH_MAX, "%s/r.%d.%d.%d.region", directory, position[0], position[1], position[2]);
+
+    return length >= 0 && length < REGION_PATH_MAX;
+}
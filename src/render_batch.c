@@ -1,97 +1,191 @@
 #include "render_batch.h"
 
+#include <stdio.h>
+#include <stddef.h>
+
 #include "SDL2/SDL.h"
 
 #include "core.h"
+#include "render_state.h"
+#include "stream_buffer.h"
+#include "vertex_format.h"
 
 extern core_data CORE;
 
-void LoadRenderBatch(const GLuint triangles_count) {
-    glGenVertexArrays(1, &CORE.render_batch.vao_id);
-    glGenBuffers(1, &CORE.render_batch.vbo_id);
-    glGenBuffers(1, &CORE.render_batch.ebo_id);
+// 'vert' is uploaded as-is, so it must not contain any padding: X, Y, Z + R, G, B, A + U, V + ID
+typedef char vert_layout_check[sizeof(vert) == (3 + 4 + 2 + 1) * sizeof(GLfloat) ? 1 : -1];
+
+// Attribute locations of res/shaders/vertex.glsl
+static const vertex_format vert_format = {
+    .stride = sizeof(vert),
+    .attributes_count = 4,
+    .attributes = {
+        { 0, 3, GL_FLOAT, VERTEX_ATTRIBUTE_FLOAT, offsetof(vert, position) },
+        { 1, 4, GL_FLOAT, VERTEX_ATTRIBUTE_FLOAT, offsetof(vert, color) },
+        { 2, 2, GL_FLOAT, VERTEX_ATTRIBUTE_FLOAT, offsetof(vert, texcoord) },
+        { 3, 1, GL_FLOAT, VERTEX_ATTRIBUTE_FLOAT, offsetof(vert, texid) },
+    }
+};
+
+// Doubles 'count_max' until 'needed' fits. Stops at 'needed' where doubling would wrap around.
+static GLuint GetRenderBatchCountMax(GLuint count_max, GLuint needed) {
+    while(count_max < needed) {
+        if(count_max > SDL_MAX_UINT32 / 2) {
+            return needed;
+        }
+
+        count_max *= 2;
+    }
+
+    return count_max;
+}
+
+// Makes room for the data about to be pushed, following the batch policy.
+// Vertices pushed after the last index push are still referenced by the upcoming indices,
+// so a flush keeps them and moves them to the front of the batch.
+static bool ReserveRenderBatch(GLuint vertices_count, GLuint indices_count) {
+    if(vertices_count > SDL_MAX_UINT32 - CORE.render_batch.vertices_count || indices_count > SDL_MAX_UINT32 - CORE.render_batch.indices_count) {
+        fprintf(stderr, "[ERR] RENDER_BATCH: Push too large for the batch | Vertices: %u | Indices: %u\n", vertices_count, indices_count);
+
+        return false;
+    }
+
+    GLuint vertices_needed = CORE.render_batch.vertices_count + vertices_count;
+    GLuint indices_needed = CORE.render_batch.indices_count + indices_count;
+
+    if(vertices_needed <= CORE.render_batch.vertices_count_max && indices_needed <= CORE.render_batch.indices_count_max) {
+        return true;
+    }
+
+    if(CORE.render_batch.policy == RENDER_BATCH_FLUSH) {
+        FlushRenderBatch();
+
+        vertices_needed = CORE.render_batch.vertices_count + vertices_count;
+        indices_needed = CORE.render_batch.indices_count + indices_count;
+
+        if(vertices_needed <= CORE.render_batch.vertices_count_max && indices_needed <= CORE.render_batch.indices_count_max) {
+            return true;
+        }
+
+        // A single push larger than the whole batch can only be handled by growing it
+    }
+
+    if(vertices_needed > CORE.render_batch.vertices_count_max) {
+        GLuint count_max = GetRenderBatchCountMax(CORE.render_batch.vertices_count_max ? CORE.render_batch.vertices_count_max : 4, vertices_needed);
+
+        vert* vertices = (vert*) SDL_realloc(CORE.render_batch.vertices, count_max * sizeof(vert));
+        if(!vertices) {
+            fprintf(stderr, "[ERR] RENDER_BATCH: Could not grow the batch vertices | Count: %u\n", count_max);
+
+            return false;
+        }
+
+        CORE.render_batch.vertices = vertices;
+        CORE.render_batch.vertices_count_max = count_max;
+    }
+
+    if(indices_needed > CORE.render_batch.indices_count_max) {
+        GLuint count_max = GetRenderBatchCountMax(CORE.render_batch.indices_count_max ? CORE.render_batch.indices_count_max : 6, indices_needed);
+
+        GLuint* indices = (GLuint*) SDL_realloc(CORE.render_batch.indices, count_max * sizeof(GLuint));
+        if(!indices) {
+            fprintf(stderr, "[ERR] RENDER_BATCH: Could not grow the batch indices | Count: %u\n", count_max);
+
+            return false;
+        }
+
+        CORE.render_batch.indices = indices;
+        CORE.render_batch.indices_count_max = count_max;
+    }
+
+    return true;
+}
+
+void LoadRenderBatch(const GLuint quads_count, render_batch_policy policy) {
+    // Each region of the streams holds a full batch
+    // Vertices are aligned to whole vertices, so they can be addressed with a base vertex
+    LoadStreamBuffer(&CORE.render_batch.vertex_stream, quads_count * 4 * sizeof(vert), sizeof(vert));
+    LoadStreamBuffer(&CORE.render_batch.index_stream, quads_count * 6 * sizeof(GLuint), sizeof(GLuint));
 
-    CORE.render_batch.vertices_count_max = triangles_count * 3;
-    CORE.render_batch.indices_count_max = triangles_count * 3;
+    // The layout never changes, so it is recorded once and every flush only binds the VAO
+    CORE.render_batch.vao_id = CreateVertexArray(&vert_format, CORE.render_batch.vertex_stream.buffer_id, CORE.render_batch.index_stream.buffer_id);
+
+    // Every quad shares 4 vertices between its 2 triangles (6 indices)
+    CORE.render_batch.vertices_count_max = quads_count * 4;
+    CORE.render_batch.indices_count_max = quads_count * 6;
 
     CORE.render_batch.vertices = (vert*) SDL_calloc(CORE.render_batch.vertices_count_max, sizeof(vert));
     CORE.render_batch.indices = (GLuint*) SDL_calloc(CORE.render_batch.indices_count_max, sizeof(GLuint));
 
     CORE.render_batch.vertices_count = 0;
     CORE.render_batch.indices_count = 0;
+    CORE.render_batch.indices_base = 0;
+
+    CORE.render_batch.policy = policy;
+    CORE.render_batch.flush_count = 0;
 }
 
 void UnloadRenderBatch() {
     SDL_free(CORE.render_batch.vertices);
     SDL_free(CORE.render_batch.indices);
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-
-    glDeleteBuffers(1, &CORE.render_batch.vbo_id);
-    glDeleteBuffers(1, &CORE.render_batch.ebo_id);
-
-    glBindVertexArray(0);
-    glDeleteVertexArrays(1, &CORE.render_batch.vao_id);
+    DeleteRenderStateVertexArray(&CORE.render_batch.vao_id);
+    UnloadStreamBuffer(&CORE.render_batch.vertex_stream);
+    UnloadStreamBuffer(&CORE.render_batch.index_stream);
 }
 
-void DrawRenderBatch() {
-    glBindVertexArray(CORE.render_batch.vao_id);
-
-    const GLuint vertices_stride = 3 /* X, Y, Z */ + 4 /* R, G, B, A */ + 2 /* U, V */ + 1 /* ID */;
-    GLfloat vertices[CORE.render_batch.vertices_count * vertices_stride];
-
-    for(int data_index = 0, vert_index = 0; data_index < CORE.render_batch.vertices_count * vertices_stride; vert_index++) {
-        vertices[data_index++] = CORE.render_batch.vertices[vert_index].position[0];
-        vertices[data_index++] = CORE.render_batch.vertices[vert_index].position[1];
-        vertices[data_index++] = CORE.render_batch.vertices[vert_index].position[2];
+void FlushRenderBatch() {
+    if(CORE.render_batch.indices_count == 0) {
+        return;
+    }
 
-        vertices[data_index++] = CORE.render_batch.vertices[vert_index].color[0];
-        vertices[data_index++] = CORE.render_batch.vertices[vert_index].color[1];
-        vertices[data_index++] = CORE.render_batch.vertices[vert_index].color[2];
-        vertices[data_index++] = CORE.render_batch.vertices[vert_index].color[3];
+    GLuint vertex_buffer = CORE.render_batch.vertex_stream.buffer_id;
+    GLuint index_buffer = CORE.render_batch.index_stream.buffer_id;
 
-        vertices[data_index++] = CORE.render_batch.vertices[vert_index].texcoord[0];
-        vertices[data_index++] = CORE.render_batch.vertices[vert_index].texcoord[1];
+    GLintptr vertices_offset = PushStreamBuffer(&CORE.render_batch.vertex_stream, CORE.render_batch.vertices, CORE.render_batch.vertices_count * sizeof(vert));
+    GLintptr indices_offset = PushStreamBuffer(&CORE.render_batch.index_stream, CORE.render_batch.indices, CORE.render_batch.indices_count * sizeof(GLuint));
 
-        vertices[data_index++] = CORE.render_batch.vertices[vert_index].texid;
+    // A grown batch may have grown the streams, which replaces their buffers
+    if(CORE.render_batch.vertex_stream.buffer_id != vertex_buffer || CORE.render_batch.index_stream.buffer_id != index_buffer) {
+        DeleteRenderStateVertexArray(&CORE.render_batch.vao_id);
+        CORE.render_batch.vao_id = CreateVertexArray(&vert_format, CORE.render_batch.vertex_stream.buffer_id, CORE.render_batch.index_stream.buffer_id);
     }
 
-    glBindBuffer(GL_ARRAY_BUFFER, CORE.render_batch.vbo_id);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, CORE.render_batch.ebo_id);
-    
-    glBufferData(GL_ARRAY_BUFFER, CORE.render_batch.vertices_count * vertices_stride * sizeof(GLfloat), vertices, GL_DYNAMIC_DRAW);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, CORE.render_batch.indices_count * sizeof(GLuint), CORE.render_batch.indices, GL_DYNAMIC_DRAW);
+    if(vertices_offset >= 0 && indices_offset >= 0) {
+        BindRenderStateVertexArray(CORE.render_batch.vao_id);
+        UseRenderStateProgram(CORE.shaders.shader_program.id);
 
-    glEnableVertexAttribArray(0);
-    glEnableVertexAttribArray(1);
-    glEnableVertexAttribArray(2);
-    glEnableVertexAttribArray(3);
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, vertices_stride * sizeof(GLfloat), (void*) ((0) * sizeof(GLfloat)));
-    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, vertices_stride * sizeof(GLfloat), (void*) ((0 + 3) * sizeof(GLfloat)));
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, vertices_stride * sizeof(GLfloat), (void*) ((0 + 3 + 4) * sizeof(GLfloat)));
-    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, vertices_stride * sizeof(GLfloat), (void*) ((0 + 3 + 4 + 2) * sizeof(GLfloat)));
+        glDrawElementsBaseVertex(GL_TRIANGLES, CORE.render_batch.indices_count, GL_UNSIGNED_INT, (void*) indices_offset, vertices_offset / sizeof(vert));
+    }
 
-    glUseProgram(CORE.shaders.shader_program_id);
+    CORE.render_batch.flush_count++;
 
-    glDrawElements(GL_TRIANGLES, CORE.render_batch.indices_count, GL_UNSIGNED_INT, 0);
+    // Keep the vertices that the next index push still refers to
+    GLuint vertices_pending = CORE.render_batch.vertices_count - CORE.render_batch.indices_base;
+    SDL_memmove(CORE.render_batch.vertices, &CORE.render_batch.vertices[CORE.render_batch.indices_base], vertices_pending * sizeof(vert));
 
-    glDisableVertexAttribArray(0);
-    glDisableVertexAttribArray(1);
-    glDisableVertexAttribArray(2);
-    glDisableVertexAttribArray(3);
+    CORE.render_batch.vertices_count = vertices_pending;
+    CORE.render_batch.indices_count = 0;
+    CORE.render_batch.indices_base = 0;
+}
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+void DrawRenderBatch() {
+    FlushRenderBatch();
 
     CORE.render_batch.vertices_count = 0;
-    CORE.render_batch.indices_count = 0;
+    CORE.render_batch.indices_base = 0;
+
+    // Once per frame: the draws of this frame are fenced and the next frame writes to the next regions
+    AdvanceStreamBuffer(&CORE.render_batch.vertex_stream);
+    AdvanceStreamBuffer(&CORE.render_batch.index_stream);
 }
 
 void PushRenderBatchVertexData(vec3* positions, vec4* colors, vec2* texcoord, GLint texid, GLuint data_count) {
-    for(int vert_index = 0; vert_index < data_count; vert_index++) {
+    if(!ReserveRenderBatch(data_count, 0)) {
+        return;
+    }
+
+    for(GLuint vert_index = 0; vert_index < data_count; vert_index++) {
         CORE.render_batch.vertices[CORE.render_batch.vertices_count++] = (vert) {
             .position[0] = positions[vert_index][0],
             .position[1] = positions[vert_index][1],
@@ -110,16 +204,41 @@ void PushRenderBatchVertexData(vec3* positions, vec4* colors, vec2* texcoord, GL
     }
 }
 
+void PushRenderBatchVertices(vert* vertices, GLuint data_count) {
+    if(!ReserveRenderBatch(data_count, 0)) {
+        return;
+    }
+
+    SDL_memcpy(&CORE.render_batch.vertices[CORE.render_batch.vertices_count], vertices, data_count * sizeof(vert));
+    CORE.render_batch.vertices_count += data_count;
+}
+
 void PushRenderBatchIndexData(GLuint* index_data, GLuint data_count) {
-    int largest_indicy = 0;
-    for(int indices = 0; indices < CORE.render_batch.indices_count; indices++) {
-        if(largest_indicy < CORE.render_batch.indices[indices]) {
-            largest_indicy = CORE.render_batch.indices[indices];
+    if(!ReserveRenderBatch(0, data_count)) {
+        return;
+    }
+
+    // Indices are relative to the vertices pushed since the previous index push (a flush may have moved them)
+    GLuint indicy_base = CORE.render_batch.indices_base;
+
+    // Indices pointing at vertices which were dropped would make the GPU read out of bounds
+    GLuint vertices_pushed = CORE.render_batch.vertices_count - indicy_base;
+    for(GLuint indices = 0; indices < data_count; indices++) {
+        if(index_data[indices] >= vertices_pushed) {
+            fprintf(stderr, "[WARN] RENDER_BATCH: Dropping indices past the pushed vertices | Index: %u | Vertices: %u\n", index_data[indices], vertices_pushed);
+
+            // Their vertices go too, or the next push would count them as its own
+            CORE.render_batch.vertices_count = indicy_base;
+
+            return;
         }
     }
 
-    int indicy_base = largest_indicy + (largest_indicy <= 0 ? 0 : 1);
-    for(int indices = 0; indices < data_count; indices++) {
-        CORE.render_batch.indices[CORE.render_batch.indices_count++] = indicy_base + index_data[indices];
+    GLuint* destination = &CORE.render_batch.indices[CORE.render_batch.indices_count];
+    for(GLuint indices = 0; indices < data_count; indices++) {
+        destination[indices] = indicy_base + index_data[indices];
     }
+
+    CORE.render_batch.indices_count += data_count;
+    CORE.render_batch.indices_base = CORE.render_batch.vertices_count;
 }
@@ -0,0 +1,169 @@
+#include "render_state.h"
+
+#include <stdio.h>
+
+#include "SDL2/SDL.h"
+
+#include "core.h"
+
+extern core_data CORE;
+
+// Counts the call as issued when the value changes (or isn't known yet), as filtered otherwise
+static bool UpdateRenderStateValue(render_state_value* state, GLuint value) {
+    if(state->valid && state->value == value) {
+        CORE.stats.current.gl_calls_filtered++;
+
+        return false;
+    }
+
+    state->value = value;
+    state->valid = true;
+
+    CORE.stats.current.gl_calls_issued++;
+
+    return true;
+}
+
+static render_state_value* GetRenderStateCapability(GLenum capability) {
+    switch(capability) {
+        case GL_BLEND: return &CORE.render_state.blend;
+        case GL_DEPTH_TEST: return &CORE.render_state.depth_test;
+        case GL_CULL_FACE: return &CORE.render_state.cull_face;
+
+        default: return NULL;
+    }
+}
+
+static render_state_value* GetRenderStateBuffer(GLenum target) {
+    switch(target) {
+        case GL_ARRAY_BUFFER: return &CORE.render_state.array_buffer;
+        case GL_ELEMENT_ARRAY_BUFFER: return &CORE.render_state.element_array_buffer;
+        case GL_UNIFORM_BUFFER: return &CORE.render_state.uniform_buffer;
+        case GL_COPY_READ_BUFFER: return &CORE.render_state.copy_read_buffer;
+        case GL_COPY_WRITE_BUFFER: return &CORE.render_state.copy_write_buffer;
+        case GL_DRAW_INDIRECT_BUFFER: return &CORE.render_state.draw_indirect_buffer;
+
+        default: return NULL;
+    }
+}
+
+// The element buffer and the attribute arrays belong to the vertex array, they are unknown after switching it
+static void ForgetRenderStateVertexArray() {
+    CORE.render_state.element_array_buffer.valid = false;
+
+    for(int index = 0; index < RENDER_STATE_VERTEX_ATTRIBS_MAX; index++) {
+        CORE.render_state.vertex_attribs[index].valid = false;
+    }
+}
+
+void ResetRenderState() {
+    CORE.render_state = (render_state) { 0 };
+}
+
+void SetRenderStateCapability(GLenum capability, bool enabled) {
+    render_state_value* state = GetRenderStateCapability(capability);
+    if(!state) {
+        fprintf(stderr, "[WARN] STATE: Capability not tracked, issued directly | Capability: 0x%x\n", capability);
+        enabled ? glEnable(capability) : glDisable(capability);
+
+        return;
+    }
+
+    if(!UpdateRenderStateValue(state, enabled)) {
+        return;
+    }
+
+    enabled ? glEnable(capability) : glDisable(capability);
+}
+
+void SetRenderStateBlendFunc(GLenum source, GLenum destination) {
+    // Both factors are set by a single call, so they are tracked as a single value (blend factors fit in 16 bits)
+    if(UpdateRenderStateValue(&CORE.render_state.blend_func, (source << 16) | destination)) {
+        glBlendFunc(source, destination);
+    }
+}
+
+void SetRenderStateCullFace(GLenum mode) {
+    if(UpdateRenderStateValue(&CORE.render_state.cull_face_mode, mode)) {
+        glCullFace(mode);
+    }
+}
+
+void SetRenderStateFrontFace(GLenum mode) {
+    if(UpdateRenderStateValue(&CORE.render_state.front_face, mode)) {
+        glFrontFace(mode);
+    }
+}
+
+void UseRenderStateProgram(GLuint program) {
+    if(UpdateRenderStateValue(&CORE.render_state.program, program)) {
+        glUseProgram(program);
+    }
+}
+
+void BindRenderStateVertexArray(GLuint vertex_array) {
+    if(!UpdateRenderStateValue(&CORE.render_state.vertex_array, vertex_array)) {
+        return;
+    }
+
+    glBindVertexArray(vertex_array);
+    ForgetRenderStateVertexArray();
+}
+
+void BindRenderStateBuffer(GLenum target, GLuint buffer) {
+    render_state_value* state = GetRenderStateBuffer(target);
+    if(!state) {
+        fprintf(stderr, "[WARN] STATE: Buffer target not tracked, issued directly | Target: 0x%x\n", target);
+        glBindBuffer(target, buffer);
+
+        return;
+    }
+
+    if(UpdateRenderStateValue(state, buffer)) {
+        glBindBuffer(target, buffer);
+    }
+}
+
+void SetRenderStateVertexAttribArray(GLuint index, bool enabled) {
+    if(index >= RENDER_STATE_VERTEX_ATTRIBS_MAX) {
+        enabled ? glEnableVertexAttribArray(index) : glDisableVertexAttribArray(index);
+
+        return;
+    }
+
+    if(!UpdateRenderStateValue(&CORE.render_state.vertex_attribs[index], enabled)) {
+        return;
+    }
+
+    enabled ? glEnableVertexAttribArray(index) : glDisableVertexAttribArray(index);
+}
+
+void DeleteRenderStateBuffer(GLuint* buffer) {
+    render_state_value* states[] = {
+        &CORE.render_state.array_buffer,
+        &CORE.render_state.element_array_buffer,
+        &CORE.render_state.uniform_buffer,
+        &CORE.render_state.copy_read_buffer,
+        &CORE.render_state.copy_write_buffer,
+        &CORE.render_state.draw_indirect_buffer
+    };
+
+    for(size_t index = 0; index < sizeof(states) / sizeof(states[0]); index++) {
+        if(states[index]->valid && states[index]->value == *buffer) {
+            states[index]->value = 0;
+        }
+    }
+
+    glDeleteBuffers(1, buffer);
+    *buffer = 0;
+}
+
+void DeleteRenderStateVertexArray(GLuint* vertex_array) {
+    if(CORE.render_state.vertex_array.valid && CORE.render_state.vertex_array.value == *vertex_array) {
+        CORE.render_state.vertex_array.value = 0;
+        ForgetRenderStateVertexArray();
+    }
+
+    glDeleteVertexArrays(1, vertex_array);
+    *vertex_array = 0;
+}
@@ -6,9 +6,139 @@
 #include "SDL2/SDL.h"
 
 #include "core.h"
+#include "render_state.h"
 
 extern core_data CORE;
 
+static const GLchar* shader_loc_names[SHADER_LOC_COUNT] = {
+    "uMatrixModel",
+};
+
+// Bytes taken by a single element of a uniform of the given type
+static GLsizei GetShaderUniformTypeSize(GLenum type) {
+    switch(type) {
+        case GL_FLOAT: return sizeof(GLfloat);
+        case GL_FLOAT_VEC2: return 2 * sizeof(GLfloat);
+        case GL_FLOAT_VEC3: return 3 * sizeof(GLfloat);
+        case GL_FLOAT_VEC4: return 4 * sizeof(GLfloat);
+        case GL_FLOAT_MAT3: return 9 * sizeof(GLfloat);
+        case GL_FLOAT_MAT4: return 16 * sizeof(GLfloat);
+        case GL_INT_VEC2: case GL_UNSIGNED_INT_VEC2: return 2 * sizeof(GLint);
+        case GL_INT_VEC3: case GL_UNSIGNED_INT_VEC3: return 3 * sizeof(GLint);
+        case GL_INT_VEC4: case GL_UNSIGNED_INT_VEC4: return 4 * sizeof(GLint);
+
+        default: return sizeof(GLint); // Scalars, booleans and samplers
+    }
+}
+
+// Arrays are reported as "name[0]", the suffix is dropped so they can be looked up by their plain name
+static void CopyShaderName(GLchar* destination, const GLchar* source) {
+    SDL_strlcpy(destination, source, SHADER_NAME_LENGTH_MAX);
+
+    GLchar* bracket = SDL_strchr(destination, '[');
+    if(bracket) {
+        *bracket = '\0';
+    }
+}
+
+static void ReflectProgram(shader_program* program) {
+    GLint uniforms_count = 0;
+    GLint attributes_count = 0;
+
+    glGetProgramiv(program->id, GL_ACTIVE_UNIFORMS, &uniforms_count);
+    glGetProgramiv(program->id, GL_ACTIVE_ATTRIBUTES, &attributes_count);
+
+    if(uniforms_count > 0) {
+        program->uniforms = (shader_uniform*) SDL_calloc(uniforms_count, sizeof(shader_uniform));
+        if(!program->uniforms) {
+            fprintf(stderr, "[ERR] PROGRAM: Could not allocate the uniforms\n");
+
+            return;
+        }
+    }
+
+    if(attributes_count > 0) {
+        program->attributes = (shader_attribute*) SDL_calloc(attributes_count, sizeof(shader_attribute));
+        if(!program->attributes) {
+            fprintf(stderr, "[ERR] PROGRAM: Could not allocate the attributes\n");
+
+            return;
+        }
+    }
+
+    for(GLint index = 0; index < uniforms_count; index++) {
+        GLchar name[SHADER_NAME_LENGTH_MAX];
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(program->id, index, sizeof(name), NULL, &size, &type, name);
+
+        GLint location = glGetUniformLocation(program->id, name);
+        if(location < 0) {
+            continue; // Members of uniform blocks have no location
+        }
+
+        shader_uniform* uniform = &program->uniforms[program->uniforms_count];
+        CopyShaderName(uniform->name, name);
+        uniform->location = location;
+        uniform->type = type;
+        uniform->size = size;
+
+        uniform->value_size = size * GetShaderUniformTypeSize(type);
+        uniform->value = SDL_calloc(1, uniform->value_size);
+        if(!uniform->value) {
+            fprintf(stderr, "[ERR] PROGRAM: Could not allocate the uniform cache | Name: %s\n", uniform->name);
+
+            continue;
+        }
+
+        program->uniforms_count++;
+    }
+
+    for(GLint index = 0; index < attributes_count; index++) {
+        GLchar name[SHADER_NAME_LENGTH_MAX];
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveAttrib(program->id, index, sizeof(name), NULL, &size, &type, name);
+
+        shader_attribute* attribute = &program->attributes[program->attributes_count++];
+        CopyShaderName(attribute->name, name);
+        attribute->location = glGetAttribLocation(program->id, name);
+        attribute->type = type;
+        attribute->size = size;
+    }
+
+    for(int loc = 0; loc < SHADER_LOC_COUNT; loc++) {
+        program->locs[loc] = GetShaderUniform(program, shader_loc_names[loc]);
+    }
+
+    GLuint frame_block = glGetUniformBlockIndex(program->id, SHADER_FRAME_BLOCK_NAME);
+    if(frame_block != GL_INVALID_INDEX) {
+        glUniformBlockBinding(program->id, frame_block, SHADER_FRAME_BINDING);
+    }
+
+    fprintf(stdout, "[INFO] PROGRAM: Program reflected successfully | ID: %u | Uniforms: %u | Attributes: %u\n", program->id, program->uniforms_count, program->attributes_count);
+}
+
+// Remembers the value about to be uploaded, false when the program already holds it
+static bool UpdateShaderUniform(shader_uniform* uniform, const void* value, GLsizei value_size) {
+    if(!uniform) {
+        return false;
+    }
+
+    if(value_size > uniform->value_size) {
+        value_size = uniform->value_size;
+    }
+
+    if(uniform->uploaded && SDL_memcmp(uniform->value, value, value_size) == 0) {
+        return false;
+    }
+
+    SDL_memcpy(uniform->value, value, value_size);
+    uniform->uploaded = true;
+
+    return true;
+}
+
 GLchar* LoadShaderCode(const GLchar* filepath) {
     FILE* shader_file = fopen(filepath, "rb");
     if(!shader_file) {
@@ -62,24 +192,29 @@ GLuint CreateShader(const GLchar* shader_code_filepath, GLuint shader_type) {
     return result;
 }
 
-GLuint CreateProgram(GLuint vertex_shader, GLuint fragmnet_shader) {
-    GLuint result = glCreateProgram();
+shader_program CreateProgram(GLuint vertex_shader, GLuint fragmnet_shader) {
+    shader_program result = { 0 };
+    result.id = glCreateProgram();
 
-    glAttachShader(result, vertex_shader);
-    glAttachShader(result, fragmnet_shader);
-    glLinkProgram(result);
+    glAttachShader(result.id, vertex_shader);
+    glAttachShader(result.id, fragmnet_shader);
+    glLinkProgram(result.id);
 
     GLint link_success;
-    glGetProgramiv(result, GL_LINK_STATUS, &link_success);
+    glGetProgramiv(result.id, GL_LINK_STATUS, &link_success);
     if(link_success != GL_TRUE) {
         GLchar buffer[1024];
-        glGetProgramInfoLog(result, 1024, 0, buffer);
+        glGetProgramInfoLog(result.id, 1024, 0, buffer);
         fprintf(stderr, "[ERR] PROGRAM: %s\n", buffer);   
     }
 
     DeleteShader(vertex_shader);
     DeleteShader(fragmnet_shader);
 
+    if(link_success == GL_TRUE) {
+        ReflectProgram(&result);
+    }
+
     return result;
 }
 
@@ -92,19 +227,132 @@ GLuint* GetDefaultShader(GLuint shader_type) {
     }
 }
 
-GLuint* GetDefaultProgram() {
-    return &CORE.shaders.shader_program_id;
+shader_program* GetDefaultProgram() {
+    return &CORE.shaders.shader_program;
+}
+
+shader_program* GetChunkProgram() {
+    return &CORE.shaders.chunk_program;
 }
 
 void DeleteShader(GLuint shader) {
     glDeleteShader(shader);
 }
 
-void DeleteProgram(GLuint program) {
-    glUseProgram(0);
-    glDeleteProgram(program);
+void DeleteProgram(shader_program* program) {
+    UseRenderStateProgram(0);
+    glDeleteProgram(program->id);
+
+    for(GLuint index = 0; index < program->uniforms_count; index++) {
+        SDL_free(program->uniforms[index].value);
+    }
+
+    SDL_free(program->uniforms);
+    SDL_free(program->attributes);
+
+    *program = (shader_program) { 0 };
 }
 
-GLint GetShaderUniformLocation(GLuint program, const GLchar* uniform_name) {
-    return glGetUniformLocation(program, uniform_name);
-}
\ No newline at end of file
+shader_uniform* GetShaderUniform(shader_program* program, const GLchar* uniform_name) {
+    for(GLuint index = 0; index < program->uniforms_count; index++) {
+        if(SDL_strcmp(program->uniforms[index].name, uniform_name) == 0) {
+            return &program->uniforms[index];
+        }
+    }
+
+    return NULL;
+}
+
+GLint GetShaderUniformLocation(shader_program* program, const GLchar* uniform_name) {
+    shader_uniform* uniform = GetShaderUniform(program, uniform_name);
+
+    return uniform ? uniform->location : -1;
+}
+
+GLint GetShaderAttributeLocation(shader_program* program, const GLchar* attribute_name) {
+    for(GLuint index = 0; index < program->attributes_count; index++) {
+        if(SDL_strcmp(program->attributes[index].name, attribute_name) == 0) {
+            return program->attributes[index].location;
+        }
+    }
+
+    return -1;
+}
+
+bool SetShaderUniformInt(shader_uniform* uniform, GLint value) {
+    if(!UpdateShaderUniform(uniform, &value, sizeof(value))) {
+        return false;
+    }
+
+    glUniform1i(uniform->location, value);
+
+    return true;
+}
+
+bool SetShaderUniformFloat(shader_uniform* uniform, GLfloat value) {
+    if(!UpdateShaderUniform(uniform, &value, sizeof(value))) {
+        return false;
+    }
+
+    glUniform1f(uniform->location, value);
+
+    return true;
+}
+
+bool SetShaderUniformVec3(shader_uniform* uniform, vec3 value) {
+    if(!UpdateShaderUniform(uniform, value, sizeof(vec3))) {
+        return false;
+    }
+
+    glUniform3fv(uniform->location, 1, value);
+
+    return true;
+}
+
+bool SetShaderUniformVec4(shader_uniform* uniform, vec4 value) {
+    if(!UpdateShaderUniform(uniform, value, sizeof(vec4))) {
+        return false;
+    }
+
+    glUniform4fv(uniform->location, 1, value);
+
+    return true;
+}
+
+bool SetShaderUniformMat4(shader_uniform* uniform, mat4 value) {
+    if(!UpdateShaderUniform(uniform, value, sizeof(mat4))) {
+        return false;
+    }
+
+    glUniformMatrix4fv(uniform->location, 1, GL_FALSE, &value[0][0]);
+
+    return true;
+}
+
+bool SetShaderUniformFloatArray(shader_uniform* uniform, const GLfloat* values, GLsizei count) {
+    if(uniform && count > uniform->size) {
+        count = uniform->size;
+    }
+
+    if(!UpdateShaderUniform(uniform, values, count * sizeof(GLfloat))) {
+        return false;
+    }
+
+    glUniform1fv(uniform->location, count, values);
+
+    return true;
+}
+
+bool SetShaderUniformVec4Array(shader_uniform* uniform, const vec4* values, GLsizei count) {
+    if(uniform && count > uniform->size) {
+        count = uniform->size;
+    }
+
+    if(!UpdateShaderUniform(uniform, values, count * sizeof(vec4))) {
+        return false;
+    }
+
+    glUniform4fv(uniform->location, count, (const GLfloat*) values);
+
+    return true;
+}
@@ -0,0 +1,183 @@
+#include "stream_buffer.h"
+
+#include <stdio.h>
+
+#include "SDL2/SDL.h"
+
+#include "render_state.h"
+
+#define STREAM_BUFFER_WAIT_TIMEOUT 1000000000 // 1s, in nanoseconds
+
+// glad only loads glBufferStorage for 4.4 contexts, the extension brings it to older ones
+static bool LoadStreamBufferStorage() {
+    if(glBufferStorage) {
+        return true;
+    }
+
+    if(!SDL_GL_ExtensionSupported("GL_ARB_buffer_storage")) {
+        return false;
+    }
+
+    glad_glBufferStorage = (PFNGLBUFFERSTORAGEPROC) SDL_GL_GetProcAddress("glBufferStorage");
+
+    return glBufferStorage != NULL;
+}
+
+// The copy-write target leaves the array and element bindings (and so the bound VAO) untouched
+static bool CreateStreamBufferStorage(stream_buffer* stream) {
+    GLsizeiptr size = stream->region_size * STREAM_BUFFER_REGIONS;
+
+    glGenBuffers(1, &stream->buffer_id);
+    BindRenderStateBuffer(GL_COPY_WRITE_BUFFER, stream->buffer_id);
+
+    stream->persistent = LoadStreamBufferStorage();
+    if(stream->persistent) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+        glBufferStorage(GL_COPY_WRITE_BUFFER, size, NULL, flags);
+        stream->mapping = (GLubyte*) glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags);
+
+        if(!stream->mapping) {
+            fprintf(stderr, "[WARN] STREAM: Could not map the buffer persistently, using unsynchronized maps\n");
+
+            // Immutable storage can't be respecified, start over with a mutable one
+            DeleteRenderStateBuffer(&stream->buffer_id);
+            glGenBuffers(1, &stream->buffer_id);
+            BindRenderStateBuffer(GL_COPY_WRITE_BUFFER, stream->buffer_id);
+
+            stream->persistent = false;
+        }
+    }
+
+    if(!stream->persistent) {
+        glBufferData(GL_COPY_WRITE_BUFFER, size, NULL, GL_STREAM_DRAW);
+    }
+
+    return stream->buffer_id != 0;
+}
+
+static void DeleteStreamBufferStorage(stream_buffer* stream) {
+    for(int region = 0; region < STREAM_BUFFER_REGIONS; region++) {
+        if(stream->fences[region]) {
+            glDeleteSync(stream->fences[region]);
+            stream->fences[region] = NULL;
+        }
+    }
+
+    if(stream->mapping) {
+        BindRenderStateBuffer(GL_COPY_WRITE_BUFFER, stream->buffer_id);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        stream->mapping = NULL;
+    }
+
+    // Draws still reading the buffer keep it alive until they are done
+    DeleteRenderStateBuffer(&stream->buffer_id);
+}
+
+static void WaitStreamBufferRegion(stream_buffer* stream, GLuint region) {
+    GLsync fence = stream->fences[region];
+    if(!fence) {
+        return;
+    }
+
+    GLenum status = glClientWaitSync(fence, 0, 0);
+    if(status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+        stream->waits++;
+
+        // Flushing makes sure the fence is actually submitted, otherwise it could never signal
+        do {
+            status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, STREAM_BUFFER_WAIT_TIMEOUT);
+        } while(status == GL_TIMEOUT_EXPIRED);
+    }
+
+    glDeleteSync(fence);
+    stream->fences[region] = NULL;
+}
+
+bool LoadStreamBuffer(stream_buffer* stream, GLsizeiptr region_size, GLsizeiptr alignment) {
+    *stream = (stream_buffer) { 0 };
+    stream->alignment = alignment > 0 ? alignment : 1;
+    stream->region_size = (region_size + stream->alignment - 1) / stream->alignment * stream->alignment;
+
+    if(!CreateStreamBufferStorage(stream)) {
+        fprintf(stderr, "[ERR] STREAM: Could not create the buffer\n");
+
+        return false;
+    }
+
+    printf("[INFO] STREAM: Stream buffer created | Regions: %i x %li bytes | Persistent: %s\n", STREAM_BUFFER_REGIONS, (long) region_size, stream->persistent ? "yes" : "no");
+
+    return true;
+}
+
+void UnloadStreamBuffer(stream_buffer* stream) {
+    DeleteStreamBufferStorage(stream);
+    *stream = (stream_buffer) { 0 };
+}
+
+GLintptr PushStreamBuffer(stream_buffer* stream, const void* data, GLsizeiptr size) {
+    // Every region has to be able to hold the largest push
+    if(size > stream->region_size) {
+        GLsizeiptr region_size = stream->region_size > 0 ? stream->region_size : stream->alignment;
+        while(region_size < size) {
+            region_size *= 2;
+        }
+
+        printf("[INFO] STREAM: Growing the stream buffer | Region: %li -> %li bytes\n", (long) stream->region_size, (long) region_size);
+
+        // Draws still reading the old buffer keep it alive, so nothing has to wait here
+        DeleteStreamBufferStorage(stream);
+        stream->region_size = region_size;
+        stream->region = 0;
+        stream->offset = 0;
+
+        if(!CreateStreamBufferStorage(stream)) {
+            fprintf(stderr, "[ERR] STREAM: Could not grow the buffer\n");
+
+            return -1;
+        }
+    }
+
+    // Regions start on a multiple of the alignment, so aligning within the region is enough
+    GLsizeiptr offset = (stream->offset + stream->alignment - 1) / stream->alignment * stream->alignment;
+    if(offset + size > stream->region_size) {
+        AdvanceStreamBuffer(stream);
+        offset = 0;
+    }
+
+    GLintptr buffer_offset = stream->region * stream->region_size + offset;
+
+    if(stream->persistent) {
+        SDL_memcpy(stream->mapping + buffer_offset, data, size);
+    } else {
+        // The fences already guarantee the GPU is done with the range, so the driver doesn't have to synchronize
+        BindRenderStateBuffer(GL_COPY_WRITE_BUFFER, stream->buffer_id);
+
+        void* mapping = glMapBufferRange(GL_COPY_WRITE_BUFFER, buffer_offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        if(!mapping) {
+            fprintf(stderr, "[ERR] STREAM: Could not map the buffer range\n");
+
+            return -1;
+        }
+
+        SDL_memcpy(mapping, data, size);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    }
+
+    stream->offset = offset + size;
+
+    return buffer_offset;
+}
+
+void AdvanceStreamBuffer(stream_buffer* stream) {
+    if(stream->offset == 0) {
+        return; // Nothing written, the region is still free
+    }
+
+    stream->fences[stream->region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    stream->region = (stream->region + 1) % STREAM_BUFFER_REGIONS;
+    stream->offset = 0;
+
+    WaitStreamBufferRegion(stream, stream->region);
+}
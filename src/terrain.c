@@ -0,0 +1,364 @@
+#include "terrain.h"
+
+#include "SDL2/SDL.h"
+
+#include "chunk.h"
+#include "voxel.h"
+
+// The SIMD kernels are compiled for their instruction set only, and picked at runtime
+#if (defined (__GNUC__) || defined (__clang__)) && (defined (__x86_64__) || defined (__i386__))
+    #define TERRAIN_X86
+    #define TERRAIN_TARGET(instructions) __attribute__((target(instructions)))
+
+    #include <immintrin.h>
+#endif
+
+// Lattice hash: every axis is spread by its own odd constant, then mixed (lowbias32)
+#define TERRAIN_HASH_SEED 0x27D4EB2Fu
+#define TERRAIN_HASH_X 0x85EBCA6Bu
+#define TERRAIN_HASH_Y 0xC2B2AE35u
+#define TERRAIN_HASH_Z 0x165667B1u
+#define TERRAIN_HASH_MIX_0 0x7FEB352Du
+#define TERRAIN_HASH_MIX_1 0x846CA68Bu
+
+#define TERRAIN_OCTAVE_SEED 0x9E3779B9u // Decorrelates the octaves
+#define TERRAIN_CAVE_SEED 0x68E31DA4u // Decorrelates the caves from the heightmap
+
+// Everything along a row of samples that doesn't depend on X
+typedef struct {
+    GLuint hashes[4]; // Seed, Y and Z parts of the hash at the corners (y, z), (y + 1, z), (y, z + 1), (y + 1, z + 1)
+    GLfloat smooth_y;
+    GLfloat smooth_z;
+} terrain_noise_row;
+
+// Samples 'count' (a multiple of 8) points at x + i * step along the row
+typedef void (*terrain_noise_function)(const terrain_noise_row* row, GLfloat x, GLfloat step, GLuint count, GLfloat* values);
+
+static GLuint HashTerrainLattice(GLuint hash) {
+    hash ^= hash >> 16; hash *= TERRAIN_HASH_MIX_0;
+    hash ^= hash >> 15; hash *= TERRAIN_HASH_MIX_1;
+    hash ^= hash >> 16;
+
+    return hash;
+}
+
+// 24 bits of the hash, so the conversion to float is exact
+static GLfloat GetTerrainLatticeValue(GLuint hash) {
+    return (GLfloat) (HashTerrainLattice(hash) >> 8) * (1.0f / 16777216.0f);
+}
+
+static GLfloat SmoothTerrainNoise(GLfloat t) {
+    return t * t * (3.0f - 2.0f * t);
+}
+
+static GLfloat LerpTerrainNoise(GLfloat a, GLfloat b, GLfloat t) {
+    return a + (b - a) * t;
+}
+
+static terrain_noise_row GetTerrainNoiseRow(GLuint seed, GLfloat y, GLfloat z) {
+    GLfloat floor_y = SDL_floorf(y);
+    GLfloat floor_z = SDL_floorf(z);
+
+    GLuint hash_y = (GLuint) (int) floor_y * TERRAIN_HASH_Y;
+    GLuint hash_z = (GLuint) (int) floor_z * TERRAIN_HASH_Z;
+    GLuint hash_seed = seed * TERRAIN_HASH_SEED;
+
+    return (terrain_noise_row) {
+        .hashes = {
+            hash_seed + hash_y + hash_z,
+            hash_seed + hash_y + TERRAIN_HASH_Y + hash_z,
+            hash_seed + hash_y + hash_z + TERRAIN_HASH_Z,
+            hash_seed + hash_y + TERRAIN_HASH_Y + hash_z + TERRAIN_HASH_Z,
+        },
+        .smooth_y = SmoothTerrainNoise(y - floor_y),
+        .smooth_z = SmoothTerrainNoise(z - floor_z)
+    };
+}
+
+static void SampleTerrainNoiseScalar(const terrain_noise_row* row, GLfloat x, GLfloat step, GLuint count, GLfloat* values) {
+    for(GLuint index = 0; index < count; index++) {
+        GLfloat sample_x = x + (GLfloat) index * step;
+        GLfloat floor_x = SDL_floorf(sample_x);
+        GLfloat smooth_x = SmoothTerrainNoise(sample_x - floor_x);
+
+        GLuint hash_x0 = (GLuint) (int) floor_x * TERRAIN_HASH_X;
+        GLuint hash_x1 = hash_x0 + TERRAIN_HASH_X;
+
+        GLfloat corners[4];
+        for(int corner = 0; corner < 4; corner++) {
+            corners[corner] = LerpTerrainNoise(GetTerrainLatticeValue(hash_x0 + row->hashes[corner]), GetTerrainLatticeValue(hash_x1 + row->hashes[corner]), smooth_x);
+        }
+
+        GLfloat corner_z0 = LerpTerrainNoise(corners[0], corners[1], row->smooth_y);
+        GLfloat corner_z1 = LerpTerrainNoise(corners[2], corners[3], row->smooth_y);
+
+        values[index] = LerpTerrainNoise(corner_z0, corner_z1, row->smooth_z);
+    }
+}
+
+#if defined (TERRAIN_X86)
+
+TERRAIN_TARGET("sse4.1")
+static __m128 GetTerrainLatticeValueSSE41(__m128i hash) {
+    hash = _mm_xor_si128(hash, _mm_srli_epi32(hash, 16)); hash = _mm_mullo_epi32(hash, _mm_set1_epi32((int) TERRAIN_HASH_MIX_0));
+    hash = _mm_xor_si128(hash, _mm_srli_epi32(hash, 15)); hash = _mm_mullo_epi32(hash, _mm_set1_epi32((int) TERRAIN_HASH_MIX_1));
+    hash = _mm_xor_si128(hash, _mm_srli_epi32(hash, 16));
+
+    return _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(hash, 8)), _mm_set1_ps(1.0f / 16777216.0f));
+}
+
+TERRAIN_TARGET("sse4.1")
+static __m128 LerpTerrainNoiseSSE41(__m128 a, __m128 b, __m128 t) {
+    return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t));
+}
+
+TERRAIN_TARGET("sse4.1")
+static void SampleTerrainNoiseSSE41(const terrain_noise_row* row, GLfloat x, GLfloat step, GLuint count, GLfloat* values) {
+    const __m128 lanes = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+    const __m128 smooth_y = _mm_set1_ps(row->smooth_y);
+    const __m128 smooth_z = _mm_set1_ps(row->smooth_z);
+
+    for(GLuint index = 0; index < count; index += 4) {
+        __m128 sample_x = _mm_add_ps(_mm_set1_ps(x), _mm_mul_ps(_mm_add_ps(_mm_set1_ps((GLfloat) index), lanes), _mm_set1_ps(step)));
+        __m128 floor_x = _mm_floor_ps(sample_x);
+        __m128 t = _mm_sub_ps(sample_x, floor_x);
+        __m128 smooth_x = _mm_mul_ps(_mm_mul_ps(t, t), _mm_sub_ps(_mm_set1_ps(3.0f), _mm_mul_ps(_mm_set1_ps(2.0f), t)));
+
+        __m128i hash_x0 = _mm_mullo_epi32(_mm_cvttps_epi32(floor_x), _mm_set1_epi32((int) TERRAIN_HASH_X));
+        __m128i hash_x1 = _mm_add_epi32(hash_x0, _mm_set1_epi32((int) TERRAIN_HASH_X));
+
+        __m128 corners[4];
+        for(int corner = 0; corner < 4; corner++) {
+            __m128i hash = _mm_set1_epi32((int) row->hashes[corner]);
+
+            corners[corner] = LerpTerrainNoiseSSE41(GetTerrainLatticeValueSSE41(_mm_add_epi32(hash_x0, hash)), GetTerrainLatticeValueSSE41(_mm_add_epi32(hash_x1, hash)), smooth_x);
+        }
+
+        __m128 corner_z0 = LerpTerrainNoiseSSE41(corners[0], corners[1], smooth_y);
+        __m128 corner_z1 = LerpTerrainNoiseSSE41(corners[2], corners[3], smooth_y);
+
+        _mm_storeu_ps(&values[index], LerpTerrainNoiseSSE41(corner_z0, corner_z1, smooth_z));
+    }
+}
+
+TERRAIN_TARGET("avx2")
+static __m256 GetTerrainLatticeValueAVX2(__m256i hash) {
+    hash = _mm256_xor_si256(hash, _mm256_srli_epi32(hash, 16)); hash = _mm256_mullo_epi32(hash, _mm256_set1_epi32((int) TERRAIN_HASH_MIX_0));
+    hash = _mm256_xor_si256(hash, _mm256_srli_epi32(hash, 15)); hash = _mm256_mullo_epi32(hash, _mm256_set1_epi32((int) TERRAIN_HASH_MIX_1));
+    hash = _mm256_xor_si256(hash, _mm256_srli_epi32(hash, 16));
+
+    return _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(hash, 8)), _mm256_set1_ps(1.0f / 16777216.0f));
+}
+
+TERRAIN_TARGET("avx2")
+static __m256 LerpTerrainNoiseAVX2(__m256 a, __m256 b, __m256 t) {
+    return _mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(b, a), t));
+}
+
+TERRAIN_TARGET("avx2")
+static void SampleTerrainNoiseAVX2(const terrain_noise_row* row, GLfloat x, GLfloat step, GLuint count, GLfloat* values) {
+    const __m256 lanes = _mm256_set_ps(7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f);
+    const __m256 smooth_y = _mm256_set1_ps(row->smooth_y);
+    const __m256 smooth_z = _mm256_set1_ps(row->smooth_z);
+
+    for(GLuint index = 0; index < count; index += 8) {
+        __m256 sample_x = _mm256_add_ps(_mm256_set1_ps(x), _mm256_mul_ps(_mm256_add_ps(_mm256_set1_ps((GLfloat) index), lanes), _mm256_set1_ps(step)));
+        __m256 floor_x = _mm256_floor_ps(sample_x);
+        __m256 t = _mm256_sub_ps(sample_x, floor_x);
+        __m256 smooth_x = _mm256_mul_ps(_mm256_mul_ps(t, t), _mm256_sub_ps(_mm256_set1_ps(3.0f), _mm256_mul_ps(_mm256_set1_ps(2.0f), t)));
+
+        __m256i hash_x0 = _mm256_mullo_epi32(_mm256_cvttps_epi32(floor_x), _mm256_set1_epi32((int) TERRAIN_HASH_X));
+        __m256i hash_x1 = _mm256_add_epi32(hash_x0, _mm256_set1_epi32((int) TERRAIN_HASH_X));
+
+        __m256 corners[4];
+        for(int corner = 0; corner < 4; corner++) {
+            __m256i hash = _mm256_set1_epi32((int) row->hashes[corner]);
+
+            corners[corner] = LerpTerrainNoiseAVX2(GetTerrainLatticeValueAVX2(_mm256_add_epi32(hash_x0, hash)), GetTerrainLatticeValueAVX2(_mm256_add_epi32(hash_x1, hash)), smooth_x);
+        }
+
+        __m256 corner_z0 = LerpTerrainNoiseAVX2(corners[0], corners[1], smooth_y);
+        __m256 corner_z1 = LerpTerrainNoiseAVX2(corners[2], corners[3], smooth_y);
+
+        _mm256_storeu_ps(&values[index], LerpTerrainNoiseAVX2(corner_z0, corner_z1, smooth_z));
+    }
+}
+
+#endif // TERRAIN_X86
+
+static terrain_noise_function GetTerrainNoiseFunction(terrain_kernel kernel) {
+#if defined (TERRAIN_X86)
+    switch(kernel) {
+        case TERRAIN_KERNEL_SSE41: return SampleTerrainNoiseSSE41;
+        case TERRAIN_KERNEL_AVX2: return SampleTerrainNoiseAVX2;
+        default: break;
+    }
+#endif
+
+    return SampleTerrainNoiseScalar;
+}
+
+// Fractal sum of 'octaves' noise rows, normalized back to 0..1
+static void SampleTerrainFractal(terrain_noise_function noise, GLuint seed, GLuint octaves, GLfloat x, GLfloat y, GLfloat z, GLfloat step, GLfloat* values) {
+    GLfloat octave_values[CHUNK_SIZE];
+    GLfloat frequency = 1.0f;
+    GLfloat amplitude = 1.0f;
+    GLfloat amplitude_total = 0.0f;
+
+    for(GLuint index = 0; index < CHUNK_SIZE; index++) {
+        values[index] = 0.0f;
+    }
+
+    for(GLuint octave = 0; octave < octaves; octave++) {
+        terrain_noise_row row = GetTerrainNoiseRow(seed + octave * TERRAIN_OCTAVE_SEED, y * frequency, z * frequency);
+        noise(&row, x * frequency, step * frequency, CHUNK_SIZE, octave_values);
+
+        for(GLuint index = 0; index < CHUNK_SIZE; index++) {
+            values[index] += octave_values[index] * amplitude;
+        }
+
+        amplitude_total += amplitude;
+        frequency *= 2.0f;
+        amplitude *= 0.5f;
+    }
+
+    if(amplitude_total > 0.0f) {
+        for(GLuint index = 0; index < CHUNK_SIZE; index++) {
+            values[index] /= amplitude_total;
+        }
+    }
+}
+
+terrain_settings GetDefaultTerrainSettings(GLuint seed) {
+    terrain_kernel kernel = TERRAIN_KERNEL_SCALAR;
+
+    if(IsTerrainKernelSupported(TERRAIN_KERNEL_AVX2)) {
+        kernel = TERRAIN_KERNEL_AVX2;
+    } else if(IsTerrainKernelSupported(TERRAIN_KERNEL_SSE41)) {
+        kernel = TERRAIN_KERNEL_SSE41;
+    }
+
+    return (terrain_settings) {
+        .seed = seed,
+        .kernel = kernel,
+
+        .height_base = 16.0f,
+        .height_amplitude = 72.0f,
+        .height_scale = 96.0f,
+        .height_octaves = 4,
+
+        .cave_scale = 24.0f,
+        .cave_octaves = 2,
+        .cave_threshold = 0.72f
+    };
+}
+
+bool IsTerrainKernelSupported(terrain_kernel kernel) {
+    switch(kernel) {
+        case TERRAIN_KERNEL_SCALAR: return true;
+#if defined (TERRAIN_X86)
+        case TERRAIN_KERNEL_SSE41: return SDL_HasSSE41();
+        case TERRAIN_KERNEL_AVX2: return SDL_HasAVX2();
+#endif
+        default: return false;
+    }
+}
+
+const char* GetTerrainKernelName(terrain_kernel kernel) {
+    switch(kernel) {
+        case TERRAIN_KERNEL_SCALAR: return "scalar";
+        case TERRAIN_KERNEL_SSE41: return "sse4.1";
+        case TERRAIN_KERNEL_AVX2: return "avx2";
+        default: return "unknown";
+    }
+}
+
+void GenerateTerrain(const void* data, const int position[3], GLubyte* voxels) {
+    const terrain_settings* settings = (const terrain_settings*) data;
+
+    terrain_kernel kernel = IsTerrainKernelSupported(settings->kernel) ? settings->kernel : TERRAIN_KERNEL_SCALAR;
+    terrain_noise_function noise = GetTerrainNoiseFunction(kernel);
+
+    const int origin[3] = { position[0] * CHUNK_SIZE, position[1] * CHUNK_SIZE, position[2] * CHUNK_SIZE };
+
+    // 1. Heightmap, one row of columns at a time
+
+    GLfloat heights[CHUNK_SIZE * CHUNK_SIZE];
+    GLfloat height_max = -1.0f;
+
+    for(int z = 0; z < CHUNK_SIZE; z++) {
+        GLfloat* row = &heights[z * CHUNK_SIZE];
+
+        SampleTerrainFractal(noise, settings->seed, settings->height_octaves, origin[0] / settings->height_scale, 0.0f, (origin[2] + z) / settings->height_scale, 1.0f / settings->height_scale, row);
+
+        for(int x = 0; x < CHUNK_SIZE; x++) {
+            row[x] = settings->height_base + row[x] * settings->height_amplitude;
+            height_max = SDL_max(height_max, row[x]);
+        }
+    }
+
+    // Caves only remove voxels, so a chunk above every column is air
+    if(origin[1] >= height_max) {
+        SDL_memset(voxels, VOXEL_AIR, CHUNK_VOLUME);
+
+        return;
+    }
+
+    // 2. Solid voxels: under the heightmap and outside the caves.
+    // A few rows above the chunk tell how deep the top voxels are below the surface.
+
+    enum { SOLID_HEIGHT = CHUNK_SIZE + TERRAIN_SOIL_DEPTH };
+    GLubyte solid[SOLID_HEIGHT * CHUNK_SIZE * CHUNK_SIZE];
+    GLfloat caves[CHUNK_SIZE];
+
+    for(int y = 0; y < SOLID_HEIGHT; y++) {
+        GLfloat world_y = (GLfloat) (origin[1] + y);
+
+        for(int z = 0; z < CHUNK_SIZE; z++) {
+            const GLfloat* row_heights = &heights[z * CHUNK_SIZE];
+            GLubyte* row_solid = &solid[CHUNK_INDEX(0, y, z)];
+
+            bool row_empty = true;
+            for(int x = 0; x < CHUNK_SIZE; x++) {
+                row_solid[x] = world_y < row_heights[x];
+                row_empty &= !row_solid[x];
+            }
+
+            if(row_empty || settings->cave_octaves == 0) {
+                continue;
+            }
+
+            SampleTerrainFractal(noise, settings->seed ^ TERRAIN_CAVE_SEED, settings->cave_octaves, origin[0] / settings->cave_scale, world_y / settings->cave_scale, (origin[2] + z) / settings->cave_scale, 1.0f / settings->cave_scale, caves);
+
+            for(int x = 0; x < CHUNK_SIZE; x++) {
+                row_solid[x] &= caves[x] <= settings->cave_threshold;
+            }
+        }
+    }
+
+    // 3. Materials, walking every column down from the top: grass, then dirt, then stone
+
+    for(int z = 0; z < CHUNK_SIZE; z++) {
+        for(int x = 0; x < CHUNK_SIZE; x++) {
+            // Above the extra rows is assumed solid, which only matters if all of them are, and then the chunk starts with stone anyway
+            int depth = TERRAIN_SOIL_DEPTH;
+
+            for(int y = SOLID_HEIGHT - 1; y >= 0; y--) {
+                depth = solid[CHUNK_INDEX(x, y, z)] ? depth + 1 : 0;
+
+                if(y >= CHUNK_SIZE) {
+                    continue;
+                }
+
+                GLubyte type = VOXEL_AIR;
+                if(depth == 1) {
+                    type = VOXEL_GRASS;
+                } else if(depth > 1) {
+                    type = depth <= TERRAIN_SOIL_DEPTH ? VOXEL_DIRT : VOXEL_STONE;
+                }
+
+                voxels[CHUNK_INDEX(x, y, z)] = type;
+            }
+        }
+    }
+}
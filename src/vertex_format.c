@@ -0,0 +1,31 @@
+#include "vertex_format.h"
+
+#include "render_state.h"
+
+GLuint CreateVertexArray(const vertex_format* format, GLuint vertex_buffer, GLuint index_buffer) {
+    GLuint result = 0;
+    glGenVertexArrays(1, &result);
+
+    // Attribute pointers capture the array buffer bound when they are set, the index buffer is part of the VAO
+    BindRenderStateVertexArray(result);
+    BindRenderStateBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+    BindRenderStateBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer);
+
+    for(GLuint index = 0; index < format->attributes_count; index++) {
+        const vertex_attribute* attribute = &format->attributes[index];
+
+        SetRenderStateVertexAttribArray(attribute->location, true);
+
+        switch(attribute->mode) {
+            case VERTEX_ATTRIBUTE_INTEGER: {
+                glVertexAttribIPointer(attribute->location, attribute->size, attribute->type, format->stride, (void*) (GLintptr) attribute->offset);
+            } break;
+
+            default: {
+                glVertexAttribPointer(attribute->location, attribute->size, attribute->type, attribute->mode == VERTEX_ATTRIBUTE_NORMALIZED, format->stride, (void*) (GLintptr) attribute->offset);
+            } break;
+        }
+    }
+
+    return result;
+}
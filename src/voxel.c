@@ -4,203 +4,126 @@
 
 #include "render_batch.h"
 
-void RenderVoxel(vec3 position, int size, vec4 tint, bool draw_top, bool draw_down, bool draw_front, bool draw_back, bool draw_left, bool draw_right) {
-    // Layout of a basic voxel:
-    //
-    //       2 ---- 3
-    //      /|     /|
-    //     0 ---- 1 |
-    //     | 6 ---| 7
-    //     |/     |/
-    //     4 ---- 5
-    //
-
-    vec3 vertex_positions[] = {
-        { position[0],          position[1],        position[2] },          // 0,0,0
-        { position[0] + size,   position[1],        position[2] },          // 1,0,0
-        { position[0],          position[1],        position[2] + size },   // 0,0,1
-        { position[0] + size,   position[1],        position[2] + size },   // 1,0,1
-        { position[0],          position[1] - size, position[2] },          // 0,1,0
-        { position[0] + size,   position[1] - size, position[2] },          // 1,1,0
-        { position[0],          position[1] - size, position[2] + size },   // 0,1,1
-        { position[0] + size,   position[1] - size, position[2] + size },   // 1,1,1
-    };
+// Layout of a basic voxel:
+//
+//       2 ---- 3
+//      /|     /|
+//     0 ---- 1 |
+//     | 6 ---| 7
+//     |/     |/
+//     4 ---- 5
+//
+
+static const GLuint voxel_face_corners[VOXEL_FACE_COUNT][4] = {
+    { 0, 1, 2, 3 }, // Face: UP
+    { 4, 5, 6, 7 }, // Face: DOWN
+    { 2, 3, 6, 7 }, // Face: FRONT
+    { 0, 1, 4, 5 }, // Face: BACK
+    { 0, 2, 4, 6 }, // Face: LEFT
+    { 1, 3, 5, 7 }, // Face: RIGHT
+};
+
+static const GLuint voxel_face_indices[VOXEL_FACE_COUNT][6] = {
+    { 0, 1, 2, 3, 2, 1 }, // Face: UP
+    { 2, 1, 0, 1, 2, 3 }, // Face: DOWN
+    { 0, 1, 2, 3, 2, 1 }, // Face: FRONT
+    { 2, 1, 0, 1, 2, 3 }, // Face: BACK
+    { 0, 1, 2, 3, 2, 1 }, // Face: LEFT
+    { 2, 1, 0, 1, 2, 3 }, // Face: RIGHT
+};
+
+static const GLfloat voxel_face_shade[VOXEL_FACE_COUNT] = {
+    1.00f, // Face: UP
+    0.80f, // Face: DOWN
+    0.90f, // Face: FRONT
+    0.90f, // Face: BACK
+    0.85f, // Face: LEFT
+    0.85f, // Face: RIGHT
+};
+
+static const GLfloat voxel_colors[VOXEL_TYPE_COUNT][4] = {
+    { 0.00f, 0.00f, 0.00f, 0.00f }, // VOXEL_AIR
+    { 0.50f, 0.50f, 0.52f, 1.00f }, // VOXEL_STONE
+    { 0.45f, 0.31f, 0.18f, 1.00f }, // VOXEL_DIRT
+    { 0.36f, 0.62f, 0.24f, 1.00f }, // VOXEL_GRASS
+    { 1.00f, 0.86f, 0.52f, 1.00f }, // VOXEL_LAMP
+};
+
+static const GLubyte voxel_emission[VOXEL_TYPE_COUNT] = {
+    0,  // VOXEL_AIR
+    0,  // VOXEL_STONE
+    0,  // VOXEL_DIRT
+    0,  // VOXEL_GRASS
+    14, // VOXEL_LAMP
+};
 
-    GLuint index_data[] = {
-        0, 1, 2,
-        3, 2, 1
+void RenderVoxel(vec3 position, int size, vec4 tint, bool draw_top, bool draw_down, bool draw_front, bool draw_back, bool draw_left, bool draw_right) {
+    const bool draw_face[VOXEL_FACE_COUNT] = {
+        draw_top, draw_down, draw_front, draw_back, draw_left, draw_right
     };
 
-    GLuint index_data_reverse[] = {
-        2, 1, 0,
-        1, 2, 3
+    vec2 vertex_texcoord[] = {
+        { 0.0f, 0.0f },
+        { 1.0f, 0.0f },
+        { 0.0f, 1.0f },
+        { 1.0f, 1.0f },
     };
 
-    if(draw_top) { // Face: UP
-        vec3 face_vertices[4] = {
-            { vertex_positions[0][0], vertex_positions[0][1], vertex_positions[0][2] },
-            { vertex_positions[1][0], vertex_positions[1][1], vertex_positions[1][2] },
-            { vertex_positions[2][0], vertex_positions[2][1], vertex_positions[2][2] },
-            { vertex_positions[3][0], vertex_positions[3][1], vertex_positions[3][2] },
-        };
-
-        GLfloat factor = 1.0f;
-
-        vec4 face_color[] = {
-            { tint[0] * factor, tint[1] * factor, tint[2] * factor, tint[3] }, // 0,0,0
-            { tint[0] * factor, tint[1] * factor, tint[2] * factor, tint[3] }, // 1,0,0
-            { tint[0] * factor, tint[1] * factor, tint[2] * factor, tint[3] }, // 0,0,1
-            { tint[0] * factor, tint[1] * factor, tint[2] * factor, tint[3] }, // 1,0,1
-        };
-
-        vec2 vertex_texcoord[] = {
-            { 0.0f, 0.0f },
-            { 1.0f, 0.0f },
-            { 0.0f, 1.0f },
-            { 1.0f, 1.0f },
-        };
-
-        PushRenderBatchVertexData(face_vertices, face_color, vertex_texcoord, 0, 4);
-        PushRenderBatchIndexData(index_data, 6);
-    }
-
-    if(draw_down) { // Face: DOWN
-        vec3 face_vertices[4] = {
-            { vertex_positions[4][0], vertex_positions[4][1], vertex_positions[4][2] },
-            { vertex_positions[5][0], vertex_positions[5][1], vertex_positions[5][2] },
-            { vertex_positions[6][0], vertex_positions[6][1], vertex_positions[6][2] },
-            { vertex_positions[7][0], vertex_positions[7][1], vertex_positions[7][2] },
-        };
-
-        GLfloat factor = 0.80f;
-
-        vec4 face_color[] = {
-            { tint[0] * factor, tint[1] * factor, tint[2] * factor, tint[3] }, // 0,0,0
-            { tint[0] * factor, tint[1] * factor, tint[2] * factor, tint[3] }, // 1,0,0
-            { tint[0] * factor, tint[1] * factor, tint[2] * factor, tint[3] }, // 0,0,1
-            { tint[0] * factor, tint[1] * factor, tint[2] * factor, tint[3] }, // 1,0,1
-        };
-
-        vec2 vertex_texcoord[] = {
-            { 0.0f, 0.0f },
-            { 1.0f, 0.0f },
-            { 0.0f, 1.0f },
-            { 1.0f, 1.0f },
-        };
-
-        PushRenderBatchVertexData(face_vertices, face_color, vertex_texcoord, 0, 4);
-        PushRenderBatchIndexData(index_data_reverse, 6);
-    }
-
-    if(draw_front) { // Face: FRONT
-        vec3 face_vertices[4] = {
-            { vertex_positions[2][0], vertex_positions[2][1], vertex_positions[2][2] },
-            { vertex_positions[3][0], vertex_positions[3][1], vertex_positions[3][2] },
-            { vertex_positions[6][0], vertex_positions[6][1], vertex_positions[6][2] },
-            { vertex_positions[7][0], vertex_positions[7][1], vertex_positions[7][2] },
-        };
-
-        GLfloat factor = 0.90f;
-
-        vec4 face_color[] = {
-            { tint[0] * factor, tint[1] * factor, tint[2] * factor, tint[3] }, // 0,0,0
-            { tint[0] * factor, tint[1] * factor, tint[2] * factor, tint[3] }, // 1,0,0
-            { tint[0] * factor, tint[1] * factor, tint[2] * factor, tint[3] }, // 0,0,1
-            { tint[0] * factor, tint[1] * factor, tint[2] * factor, tint[3] }, // 1,0,1
-        };
-
-        vec2 vertex_texcoord[] = {
-            { 0.0f, 0.0f },
-            { 1.0f, 0.0f },
-            { 0.0f, 1.0f },
-            { 1.0f, 1.0f },
-        };
-
-        PushRenderBatchVertexData(face_vertices, face_color, vertex_texcoord, 0, 4);
-        PushRenderBatchIndexData(index_data, 6);
-    }
-
-    if(draw_back) { // Face: BACK
-        vec3 face_vertices[4] = {
-            { vertex_positions[0][0], vertex_positions[0][1], vertex_positions[0][2] },
-            { vertex_positions[1][0], vertex_positions[1][1], vertex_positions[1][2] },
-            { vertex_positions[4][0], vertex_positions[4][1], vertex_positions[4][2] },
-            { vertex_positions[5][0], vertex_positions[5][1], vertex_positions[5][2] },
-        };
-
-        GLfloat factor = 0.90f;
-
-        vec4 face_color[] = {
-            { tint[0] * factor, tint[1] * factor, tint[2] * factor, tint[3] }, // 0,0,0
-            { tint[0] * factor, tint[1] * factor, tint[2] * factor, tint[3] }, // 1,0,0
-            { tint[0] * factor, tint[1] * factor, tint[2] * factor, tint[3] }, // 0,0,1
-            { tint[0] * factor, tint[1] * factor, tint[2] * factor, tint[3] }, // 1,0,1
-        };
-
-        vec2 vertex_texcoord[] = {
-            { 0.0f, 0.0f },
-            { 1.0f, 0.0f },
-            { 0.0f, 1.0f },
-            { 1.0f, 1.0f },
-        };
+    for(int face = 0; face < VOXEL_FACE_COUNT; face++) {
+        if(!draw_face[face]) {
+            continue;
+        }
 
-        PushRenderBatchVertexData(face_vertices, face_color, vertex_texcoord, 0, 4);
-        PushRenderBatchIndexData(index_data_reverse, 6);
-    }
+        vec3 face_vertices[4];
+        GetVoxelFaceVertices(position, size, face, face_vertices);
 
-    if(draw_left) { // Face: LEFT
-        vec3 face_vertices[4] = {
-            { vertex_positions[0][0], vertex_positions[0][1], vertex_positions[0][2] },
-            { vertex_positions[2][0], vertex_positions[2][1], vertex_positions[2][2] },
-            { vertex_positions[4][0], vertex_positions[4][1], vertex_positions[4][2] },
-            { vertex_positions[6][0], vertex_positions[6][1], vertex_positions[6][2] },
-        };
-
-        GLfloat factor = 0.85f;
+        GLfloat factor = voxel_face_shade[face];
 
         vec4 face_color[] = {
-            { tint[0] * factor, tint[1] * factor, tint[2] * factor, tint[3] }, // 0,0,0
-            { tint[0] * factor, tint[1] * factor, tint[2] * factor, tint[3] }, // 1,0,0
-            { tint[0] * factor, tint[1] * factor, tint[2] * factor, tint[3] }, // 0,0,1
-            { tint[0] * factor, tint[1] * factor, tint[2] * factor, tint[3] }, // 1,0,1
-        };
-
-        vec2 vertex_texcoord[] = {
-            { 0.0f, 0.0f },
-            { 1.0f, 0.0f },
-            { 0.0f, 1.0f },
-            { 1.0f, 1.0f },
+            { tint[0] * factor, tint[1] * factor, tint[2] * factor, tint[3] },
+            { tint[0] * factor, tint[1] * factor, tint[2] * factor, tint[3] },
+            { tint[0] * factor, tint[1] * factor, tint[2] * factor, tint[3] },
+            { tint[0] * factor, tint[1] * factor, tint[2] * factor, tint[3] },
         };
 
         PushRenderBatchVertexData(face_vertices, face_color, vertex_texcoord, 0, 4);
-        PushRenderBatchIndexData(index_data, 6);
+        PushRenderBatchIndexData((GLuint*) voxel_face_indices[face], 6);
     }
+}
 
-    if(draw_right) { // Face: RIGHT
-        vec3 face_vertices[4] = {
-            { vertex_positions[1][0], vertex_positions[1][1], vertex_positions[1][2] },
-            { vertex_positions[3][0], vertex_positions[3][1], vertex_positions[3][2] },
-            { vertex_positions[5][0], vertex_positions[5][1], vertex_positions[5][2] },
-            { vertex_positions[7][0], vertex_positions[7][1], vertex_positions[7][2] },
-        };
-
-        GLfloat factor = 0.85f;
+void GetVoxelFaceVertices(vec3 position, GLfloat size, voxel_face face, vec3 vertices[4]) {
+    GetVoxelBoxFaceVertices(position, (vec3) { size, size, size }, face, vertices);
+}
 
-        vec4 face_color[] = {
-            { tint[0] * factor, tint[1] * factor, tint[2] * factor, tint[3] }, // 0,0,0
-            { tint[0] * factor, tint[1] * factor, tint[2] * factor, tint[3] }, // 1,0,0
-            { tint[0] * factor, tint[1] * factor, tint[2] * factor, tint[3] }, // 0,0,1
-            { tint[0] * factor, tint[1] * factor, tint[2] * factor, tint[3] }, // 1,0,1
-        };
+void GetVoxelBoxFaceVertices(vec3 position, vec3 size, voxel_face face, vec3 vertices[4]) {
+    for(int corner_index = 0; corner_index < 4; corner_index++) {
+        GLuint corner = voxel_face_corners[face][corner_index];
 
-        vec2 vertex_texcoord[] = {
-            { 0.0f, 0.0f },
-            { 1.0f, 0.0f },
-            { 0.0f, 1.0f },
-            { 1.0f, 1.0f },
-        };
-
-        PushRenderBatchVertexData(face_vertices, face_color, vertex_texcoord, 0, 4);
-        PushRenderBatchIndexData(index_data_reverse, 6);
+        vertices[corner_index][0] = position[0] + ((corner & 1) ? size[0] : 0.0f);
+        vertices[corner_index][1] = position[1] - ((corner & 4) ? size[1] : 0.0f);
+        vertices[corner_index][2] = position[2] + ((corner & 2) ? size[2] : 0.0f);
     }
-}
\ No newline at end of file
+}
+
+const GLuint* GetVoxelFaceIndices(voxel_face face) {
+    return voxel_face_indices[face];
+}
+
+GLfloat GetVoxelFaceShade(voxel_face face) {
+    return voxel_face_shade[face];
+}
+
+void GetVoxelColor(voxel_type type, vec4 color) {
+    color[0] = voxel_colors[type][0];
+    color[1] = voxel_colors[type][1];
+    color[2] = voxel_colors[type][2];
+    color[3] = voxel_colors[type][3];
+}
+
+bool IsVoxelOpaque(GLubyte type) {
+    return type != VOXEL_AIR;
+}
+
+GLuint GetVoxelEmission(GLubyte type) {
+    return type < VOXEL_TYPE_COUNT ? voxel_emission[type] : 0;
+}
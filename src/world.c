@@ -0,0 +1,554 @@
+#include "world.h"
+
+#include <stdio.h>
+
+#include "SDL2/SDL.h"
+#include "cglm/cglm.h"
+
+#include "job.h"
+#include "light.h"
+#include "voxel.h"
+
+#define WORLD_ENTRIES_CAPACITY_MIN 256
+
+// Offset to the adjacent chunk for every voxel_face
+static const int world_face_offsets[VOXEL_FACE_COUNT][3] = {
+    {  0,  1,  0 }, // Face: UP
+    {  0, -1,  0 }, // Face: DOWN
+    {  0,  0,  1 }, // Face: FRONT
+    {  0,  0, -1 }, // Face: BACK
+    { -1,  0,  0 }, // Face: LEFT
+    {  1,  0,  0 }, // Face: RIGHT
+};
+
+static GLuint HashWorldPosition(int x, int y, int z) {
+    GLuint hash = (GLuint) x * 73856093u ^ (GLuint) y * 19349663u ^ (GLuint) z * 83492791u;
+
+    return hash ^ (hash >> 16);
+}
+
+// Entry holding 'position', or the slot where it would go (reusing the first deleted entry on the way)
+static world_entry* FindWorldEntry(world* world, int x, int y, int z) {
+    GLuint mask = world->entries_capacity - 1;
+    world_entry* deleted = NULL;
+
+    for(GLuint index = HashWorldPosition(x, y, z) & mask; ; index = (index + 1) & mask) {
+        world_entry* entry = &world->entries[index];
+
+        switch(entry->state) {
+            case WORLD_ENTRY_EMPTY: {
+                return deleted ? deleted : entry;
+            } break;
+
+            case WORLD_ENTRY_DELETED: {
+                if(!deleted) {
+                    deleted = entry;
+                }
+            } break;
+
+            case WORLD_ENTRY_USED: {
+                if(entry->position[0] == x && entry->position[1] == y && entry->position[2] == z) {
+                    return entry;
+                }
+            } break;
+        }
+    }
+}
+
+static bool ResizeWorldEntries(world* world, GLuint capacity) {
+    world_entry* entries = (world_entry*) SDL_calloc(capacity, sizeof(world_entry));
+    if(!entries) {
+        fprintf(stderr, "[ERR] WORLD: Could not grow the chunk table | Capacity: %u\n", capacity);
+
+        return false;
+    }
+
+    world_entry* entries_previous = world->entries;
+    GLuint capacity_previous = world->entries_capacity;
+
+    world->entries = entries;
+    world->entries_capacity = capacity;
+    world->entries_deleted = 0;
+
+    // The deleted entries are left behind
+    for(GLuint index = 0; index < capacity_previous; index++) {
+        if(entries_previous[index].state == WORLD_ENTRY_USED) {
+            world_entry* entry = &entries_previous[index];
+
+            *FindWorldEntry(world, entry->position[0], entry->position[1], entry->position[2]) = *entry;
+        }
+    }
+
+    SDL_free(entries_previous);
+
+    return true;
+}
+
+static bool InsertWorldChunk(world* world, chunk* chunk) {
+    // Deleted entries make the probes longer just like used ones
+    if((world->entries_count + world->entries_deleted + 1) * 2 > world->entries_capacity) {
+        GLuint capacity = world->entries_capacity;
+        while((world->entries_count + 1) * 2 > capacity) {
+            capacity *= 2;
+        }
+
+        if(!ResizeWorldEntries(world, capacity)) {
+            return false;
+        }
+    }
+
+    world_entry* entry = FindWorldEntry(world, chunk->position[0], chunk->position[1], chunk->position[2]);
+    if(entry->state == WORLD_ENTRY_DELETED) {
+        world->entries_deleted--;
+    }
+
+    *entry = (world_entry) {
+        .state = WORLD_ENTRY_USED,
+        .position = { chunk->position[0], chunk->position[1], chunk->position[2] },
+        .chunk = chunk
+    };
+
+    world->entries_count++;
+
+    return true;
+}
+
+static void RemoveWorldEntry(world* world, world_entry* entry) {
+    entry->state = WORLD_ENTRY_DELETED;
+    entry->chunk = NULL;
+
+    world->entries_count--;
+    world->entries_deleted++;
+}
+
+static bool ReserveWorldCandidates(world* world, GLuint count) {
+    if(count <= world->candidates_count_max) {
+        return true;
+    }
+
+    GLuint count_max = world->candidates_count_max ? world->candidates_count_max : 256;
+    while(count_max < count) {
+        count_max *= 2;
+    }
+
+    world_candidate* candidates = (world_candidate*) SDL_realloc(world->candidates, count_max * sizeof(world_candidate));
+    if(!candidates) {
+        fprintf(stderr, "[ERR] WORLD: Could not grow the candidates | Count: %u\n", count_max);
+
+        return false;
+    }
+
+    world->candidates = candidates;
+    world->candidates_count_max = count_max;
+
+    return true;
+}
+
+static int CompareWorldCandidates(const void* a, const void* b) {
+    GLfloat priority_a = ((const world_candidate*) a)->priority;
+    GLfloat priority_b = ((const world_candidate*) b)->priority;
+
+    return (priority_a > priority_b) - (priority_a < priority_b);
+}
+
+// From the camera to the center of the chunk, in chunks
+static void GetWorldOffset(camera* camera, const int position[3], vec3 offset) {
+    const GLfloat chunk_size = CHUNK_SIZE * VOXEL_SIZE;
+
+    offset[0] = (position[0] + 0.5f) - camera->position[0] / chunk_size;
+    offset[1] = (position[1] + 0.5f) - camera->position[1] / chunk_size;
+    offset[2] = (position[2] + 0.5f) - camera->position[2] / chunk_size;
+}
+
+// Distance from the camera, stretched up to twice for the chunks behind it
+static GLfloat GetWorldPriority(camera* camera, const int position[3]) {
+    vec3 offset;
+    GetWorldOffset(camera, position, offset);
+
+    GLfloat distance = glm_vec3_norm(offset);
+    if(distance < 1e-3f) {
+        return 0.0f;
+    }
+
+    GLfloat facing = glm_vec3_dot(offset, camera->direction) / (distance * SDL_max(glm_vec3_norm(camera->direction), 1e-3f));
+
+    return distance * (1.5f - 0.5f * facing);
+}
+
+// Level of detail for the chunk, only changed once the distance is 'lod_hysteresis' past a threshold
+static GLuint GetWorldChunkLod(world* world, camera* camera, chunk* chunk) {
+    vec3 offset;
+    GetWorldOffset(camera, (int[3]) { chunk->position[0], chunk->position[1], chunk->position[2] }, offset);
+
+    GLfloat distance = glm_vec3_norm(offset);
+    GLuint lod = chunk->lod;
+
+    while(lod + 1 < CHUNK_LOD_COUNT && distance > world->settings.lod_distances[lod] + world->settings.lod_hysteresis) {
+        lod++;
+    }
+
+    while(lod > 0 && distance < world->settings.lod_distances[lod - 1] - world->settings.lod_hysteresis) {
+        lod--;
+    }
+
+    return lod;
+}
+
+static GLuint GetWorldDistanceSquared(world* world, int x, int z) {
+    int dx = x - world->center[0];
+    int dz = z - world->center[2];
+
+    return (GLuint) (dx * dx + dz * dz);
+}
+
+static bool IsWorldPositionWanted(world* world, int x, int y, int z) {
+    return y >= world->settings.layer_min && y < world->settings.layer_max && GetWorldDistanceSquared(world, x, z) <= world->settings.radius * world->settings.radius;
+}
+
+// Only queues a snapshot, the region writer thread does the rest
+static void SaveWorldChunk(world* world, chunk* chunk) {
+    if(world->settings.regions && chunk->modified && !chunk->generate_job) {
+        world->stats.saved += QueueRegionChunk(world->settings.regions, chunk);
+    }
+}
+
+static void SaveWorldChunks(world* world) {
+    if(!world->settings.regions || world->settings.save_interval == 0 || SDL_GetTicks() - world->save_time < world->settings.save_interval) {
+        return;
+    }
+
+    world->save_time = SDL_GetTicks();
+
+    for(GLuint index = 0; index < world->entries_capacity; index++) {
+        if(world->entries[index].state == WORLD_ENTRY_USED) {
+            SaveWorldChunk(world, world->entries[index].chunk);
+        }
+    }
+}
+
+static chunk* LoadWorldChunk(world* world, const int position[3]) {
+    chunk* chunk = LoadChunk((ivec3) { position[0], position[1], position[2] });
+    if(!chunk) {
+        return NULL;
+    }
+
+    if(!InsertWorldChunk(world, chunk)) {
+        UnloadChunk(chunk);
+
+        return NULL;
+    }
+
+    for(int face = 0; face < VOXEL_FACE_COUNT; face++) {
+        struct chunk* neighbour = GetWorldChunk(world, position[0] + world_face_offsets[face][0], position[1] + world_face_offsets[face][1], position[2] + world_face_offsets[face][2]);
+
+        if(neighbour) {
+            chunk->neighbours[face] = neighbour;
+            neighbour->neighbours[face ^ 1] = chunk;
+        }
+    }
+
+    // Chunks edited before come from the disk, everything else is generated again
+    if(world->settings.regions && ReadRegionChunk(world->settings.regions, chunk)) {
+        ShrinkChunk(chunk);
+    } else if(GetJobWorkersCount() == 0) {
+        GenerateChunk(chunk, world->settings.generator, world->settings.generator_settings);
+    } else if(!ScheduleChunkGenerate(chunk, world->settings.generator, world->settings.generator_settings)) {
+        // The job queue is full, try again next frame
+        RemoveWorldEntry(world, FindWorldEntry(world, position[0], position[1], position[2]));
+        UnloadChunk(chunk);
+
+        return NULL;
+    }
+
+    return chunk;
+}
+
+// The voxels of the neighbours that are going to be loaded too are there, so the borders are only done once
+static bool AreWorldNeighboursReady(world* world, chunk* chunk) {
+    for(int face = 0; face < VOXEL_FACE_COUNT; face++) {
+        struct chunk* neighbour = chunk->neighbours[face];
+
+        if(neighbour) {
+            if(neighbour->generate_job) {
+                return false;
+            }
+        } else if(IsWorldPositionWanted(world, chunk->position[0] + world_face_offsets[face][0], chunk->position[1] + world_face_offsets[face][1], chunk->position[2] + world_face_offsets[face][2])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Meshing also waits for the light, which makes the chunk dirty again when it changes
+static bool IsWorldChunkMeshable(world* world, chunk* chunk) {
+    if(!chunk->dirty || chunk->generate_job || chunk->mesh_job || chunk->light_job || IsChunkLightPending(chunk)) {
+        return false;
+    }
+
+    return AreWorldNeighboursReady(world, chunk);
+}
+
+static bool IsWorldChunkLightable(world* world, chunk* chunk) {
+    if(!IsChunkLightPending(chunk) || chunk->generate_job || !CanChunkLight(chunk)) {
+        return false;
+    }
+
+    return AreWorldNeighboursReady(world, chunk);
+}
+
+static void UnloadWorldChunks(world* world) {
+    GLuint distance_max = world->settings.radius + world->settings.hysteresis;
+
+    world->stats.loaded = 0;
+    world->stats.generating = 0;
+    world->stats.lighting = 0;
+    world->stats.meshing = 0;
+
+    for(GLuint index = 0; index < world->entries_capacity; index++) {
+        world_entry* entry = &world->entries[index];
+        if(entry->state != WORLD_ENTRY_USED) {
+            continue;
+        }
+
+        if(world->stats.unloaded < world->settings.unload_budget && GetWorldDistanceSquared(world, entry->position[0], entry->position[2]) > distance_max * distance_max) {
+            // Detaches itself from the neighbours, and throws away the work of its pending jobs
+            SaveWorldChunk(world, entry->chunk);
+            UnloadChunk(entry->chunk);
+            RemoveWorldEntry(world, entry);
+
+            world->stats.unloaded++;
+
+            continue;
+        }
+
+        world->stats.loaded++;
+        world->stats.generating += entry->chunk->generate_job != NULL;
+        world->stats.lighting += entry->chunk->light_job != NULL;
+        world->stats.meshing += entry->chunk->mesh_job != NULL;
+    }
+}
+
+static void LoadWorldChunks(world* world, camera* camera) {
+    if(world->complete || world->stats.generating >= world->settings.generate_in_flight_max) {
+        return;
+    }
+
+    const int radius = (int) world->settings.radius;
+    world->candidates_count = 0;
+
+    for(int z = world->center[2] - radius; z <= world->center[2] + radius; z++) {
+        for(int x = world->center[0] - radius; x <= world->center[0] + radius; x++) {
+            for(int y = world->settings.layer_min; y < world->settings.layer_max; y++) {
+                if(!IsWorldPositionWanted(world, x, y, z) || GetWorldChunk(world, x, y, z)) {
+                    continue;
+                }
+
+                if(!ReserveWorldCandidates(world, world->candidates_count + 1)) {
+                    return;
+                }
+
+                world_candidate* candidate = &world->candidates[world->candidates_count++];
+                *candidate = (world_candidate) { .chunk = NULL, .position = { x, y, z } };
+                candidate->priority = GetWorldPriority(camera, candidate->position);
+            }
+        }
+    }
+
+    world->complete = world->candidates_count == 0;
+
+    SDL_qsort(world->candidates, world->candidates_count, sizeof(world_candidate), CompareWorldCandidates);
+
+    GLuint budget = SDL_min(world->settings.generate_budget, world->settings.generate_in_flight_max - world->stats.generating);
+
+    for(GLuint index = 0; index < world->candidates_count && world->stats.generated < budget; index++) {
+        if(!LoadWorldChunk(world, world->candidates[index].position)) {
+            break;
+        }
+
+        world->stats.generated++;
+    }
+
+    world->stats.loaded += world->stats.generated;
+    world->stats.generating += GetJobWorkersCount() > 0 ? world->stats.generated : 0;
+}
+
+// Only the chunks an edit (or a new chunk) changed the light of have something to do
+static void LightWorldChunks(world* world, camera* camera) {
+    world->candidates_count = 0;
+
+    for(GLuint index = 0; index < world->entries_capacity; index++) {
+        world_entry* entry = &world->entries[index];
+        if(entry->state != WORLD_ENTRY_USED || !IsWorldChunkLightable(world, entry->chunk)) {
+            continue;
+        }
+
+        if(!ReserveWorldCandidates(world, world->candidates_count + 1)) {
+            break;
+        }
+
+        world_candidate* candidate = &world->candidates[world->candidates_count++];
+        *candidate = (world_candidate) { .chunk = entry->chunk, .position = { entry->position[0], entry->position[1], entry->position[2] } };
+        candidate->priority = GetWorldPriority(camera, candidate->position);
+    }
+
+    SDL_qsort(world->candidates, world->candidates_count, sizeof(world_candidate), CompareWorldCandidates);
+
+    for(GLuint index = 0; index < world->candidates_count && world->stats.lit < world->settings.light_budget; index++) {
+        chunk* chunk = world->candidates[index].chunk;
+
+        // Nothing is loaded above the highest layer, the sunlight comes in from there
+        bool sky = chunk->position[1] >= world->settings.layer_max - 1;
+
+        if(GetJobWorkersCount() == 0) {
+            LightChunk(chunk, sky);
+        } else if(!CanChunkLight(chunk)) {
+            continue; // An adjacent chunk was just scheduled
+        } else if(!ScheduleChunkLight(chunk, sky)) {
+            break; // The job queue is full
+        } else {
+            world->stats.lighting++;
+        }
+
+        world->stats.lit++;
+    }
+}
+
+static void MeshWorldChunks(world* world, camera* camera) {
+    world->candidates_count = 0;
+
+    for(GLuint index = 0; index < world->entries_capacity; index++) {
+        world_entry* entry = &world->entries[index];
+        if(entry->state != WORLD_ENTRY_USED) {
+            continue;
+        }
+
+        // A new level makes the chunk (and its neighbours) dirty, so it's picked up below
+        SetChunkLod(entry->chunk, GetWorldChunkLod(world, camera, entry->chunk));
+
+        if(!IsWorldChunkMeshable(world, entry->chunk)) {
+            continue;
+        }
+
+        if(!ReserveWorldCandidates(world, world->candidates_count + 1)) {
+            break;
+        }
+
+        world_candidate* candidate = &world->candidates[world->candidates_count++];
+        *candidate = (world_candidate) { .chunk = entry->chunk, .position = { entry->position[0], entry->position[1], entry->position[2] } };
+        candidate->priority = GetWorldPriority(camera, candidate->position);
+    }
+
+    SDL_qsort(world->candidates, world->candidates_count, sizeof(world_candidate), CompareWorldCandidates);
+
+    for(GLuint index = 0; index < world->candidates_count && world->stats.meshed < world->settings.mesh_budget; index++) {
+        chunk* chunk = world->candidates[index].chunk;
+
+        if(GetJobWorkersCount() == 0) {
+            BuildChunkMesh(chunk);
+            UploadChunkMesh(chunk);
+        } else if(!ScheduleChunkMesh(chunk)) {
+            break; // The job queue is full
+        } else {
+            world->stats.meshing++;
+        }
+
+        world->stats.meshed++;
+    }
+}
+
+world_settings GetDefaultWorldSettings(chunk_generator generator, const void* generator_settings) {
+    return (world_settings) {
+        .radius = 16,
+        .hysteresis = 2,
+        .layer_min = 0,
+        .layer_max = 4,
+
+        .generate_budget = 8,
+        .generate_in_flight_max = 32,
+        .light_budget = 16,
+        .mesh_budget = 8,
+        .unload_budget = 16,
+
+        .lod_distances = { 4.0f, 8.0f, 12.0f },
+        .lod_hysteresis = 0.5f,
+
+        .generator = generator,
+        .generator_settings = generator_settings,
+
+        .regions = NULL,
+        .save_interval = 5000
+    };
+}
+
+bool LoadWorld(world* world, world_settings settings) {
+    SDL_memset(world, 0, sizeof(*world));
+    world->settings = settings;
+    world->save_time = SDL_GetTicks();
+
+    if(!ResizeWorldEntries(world, WORLD_ENTRIES_CAPACITY_MIN)) {
+        return false;
+    }
+
+    printf("[INFO] WORLD: World loaded | Radius: %u | Hysteresis: %u | Layers: %d..%d | LOD distances: %.1f, %.1f, %.1f\n", settings.radius, settings.hysteresis, settings.layer_min, settings.layer_max, settings.lod_distances[0], settings.lod_distances[1], settings.lod_distances[2]);
+
+    return true;
+}
+
+void UnloadWorld(world* world) {
+    for(GLuint index = 0; index < world->entries_capacity; index++) {
+        if(world->entries[index].state == WORLD_ENTRY_USED) {
+            SaveWorldChunk(world, world->entries[index].chunk);
+            UnloadChunk(world->entries[index].chunk);
+        }
+    }
+
+    SDL_free(world->entries);
+    SDL_free(world->candidates);
+
+    SDL_memset(world, 0, sizeof(*world));
+}
+
+void UpdateWorld(world* world, camera* camera) {
+    const GLfloat chunk_size = CHUNK_SIZE * VOXEL_SIZE;
+
+    int center[3] = {
+        (int) SDL_floorf(camera->position[0] / chunk_size),
+        (int) SDL_floorf(camera->position[1] / chunk_size),
+        (int) SDL_floorf(camera->position[2] / chunk_size)
+    };
+
+    if(center[0] != world->center[0] || center[2] != world->center[2]) {
+        world->complete = false;
+    }
+
+    world->center[0] = center[0];
+    world->center[1] = center[1];
+    world->center[2] = center[2];
+
+    world->stats.generated = 0;
+    world->stats.lit = 0;
+    world->stats.meshed = 0;
+    world->stats.unloaded = 0;
+    world->stats.saved = 0;
+
+    UnloadWorldChunks(world);
+    LoadWorldChunks(world, camera);
+    LightWorldChunks(world, camera);
+    MeshWorldChunks(world, camera);
+    SaveWorldChunks(world);
+}
+
+void RenderWorld(world* world) {
+    for(GLuint index = 0; index < world->entries_capacity; index++) {
+        if(world->entries[index].state == WORLD_ENTRY_USED) {
+            DrawChunk(world->entries[index].chunk);
+        }
+    }
+}
+
+chunk* GetWorldChunk(world* world, int x, int y, int z) {
+    world_entry* entry = FindWorldEntry(world, x, y, z);
+
+    return entry->state == WORLD_ENTRY_USED ? entry->chunk : NULL;
+}